@@ -17,6 +17,11 @@
 /*--------------------------------------------------------------------------------------*/
 extern BIT BIT_TMP;
 
+/*--------------------------------------------------------------------------------------*/
+/* Running system clock in Hz: 24MHz HIRC, 24576000 once MODIFY_HIRC_24576() trimmed it  */
+/*--------------------------------------------------------------------------------------*/
+extern unsigned long xdata u32SysClock;
+
 /*--------------------------------------------------------------------------------------*/
 /* UART Initialization Functions                                                        */
 /*--------------------------------------------------------------------------------------*/
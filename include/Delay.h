@@ -14,6 +14,8 @@
 /*--------------------------------------------------------------------------------------*/
 /* Delay Functions                                                                      */
 /* These use Timer2 for accurate delays at 24MHz HIRC                                   */
+/* Timer2 is owned by timebase.c once timebase_init() runs, Timer3 by uart1.c unless  */
+/* UART1_MODE is UART1_MODE_NONE: use timebase_ms() instead                             */
 /*--------------------------------------------------------------------------------------*/
 
 /**
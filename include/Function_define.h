@@ -195,6 +195,9 @@ typedef bit             BIT;
 #define ENABLE_PIT0_P00_FALLINGEDGE     PICON|=0x04;PINEN|=0x01;PIPEN&=0xFE
 #define ENABLE_PIT0_P00_RISINGEDGE      PICON|=0x04;PINEN&=0xFE;PIPEN|=0x01
 
+#define ENABLE_PIT1_P01_FALLINGEDGE     PICON|=0x08;PINEN|=0x02;PIPEN&=0xFD
+#define ENABLE_PIT1_P01_RISINGEDGE      PICON|=0x08;PINEN&=0xFD;PIPEN|=0x02
+
 #define ENABLE_PIT5_P05_FALLINGEDGE     PICON|=0x04;PINEN|=0x20;PIPEN&=0xDF
 #define ENABLE_PIT5_P05_RISINGEDGE      PICON|=0x04;PINEN&=0xDF;PIPEN|=0x20
 #define ENABLE_PIT5_P05_BOTHEDGE        PICON|=0x04;PINEN|=0x20;PIPEN|=0x20
@@ -402,7 +402,7 @@
 #define clr_ET1                  ET1=0
 
 /* Pin Interrupt Enable (EIE register) */
-#define set_EPI                  EIE|=0x80
-#define clr_EPI                  EIE&=0x7F
+#define set_EPI                  EIE|=0x02
+#define clr_EPI                  EIE&=0xFD
 
 #endif /* __SFR_MACRO_H__ */
@@ -0,0 +1,77 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+adc_sense.h
+
+Interrupt-driven ADC sampling scheduler for MS51FB9AE
+NTC on AIN0 (P1.7): software start from the 1ms timebase tick
+LED shunts on AIN6 (P0.3) / AIN7 (P1.1): PWM-triggered in the on-phase
+--------------------------------------------------------------------------*/
+#ifndef _ADC_SENSE_H_
+#define _ADC_SENSE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "thermal.h"
+
+/* Set to 0 on boards without LED current shunts */
+#ifndef ADC_ISENSE_ENABLE
+#define ADC_ISENSE_ENABLE       1
+#endif
+
+/* ADC channel numbers (ADCHS) */
+#define ADC_CH_NTC              0       // AIN0 = P1.7
+#define ADC_CH_ISENSE_WHITE     6       // AIN6 = P0.3
+#define ADC_CH_ISENSE_YELLOW    7       // AIN7 = P1.1
+
+#define ADC_ISENSE_WHITE        0
+#define ADC_ISENSE_YELLOW       1
+
+/* 2^n conversions summed per result: 16 x 12 bit fits 16 bit */
+#define ADC_NTC_OVERSAMPLE_SHIFT    4
+#define ADC_ISENSE_OVERSAMPLE_SHIFT 3
+
+/* Shunt sample point: trigger delay after LED turn-on (driver settling),
+   ADC clocks at 3MHz; pulses shorter than ADC_ISENSE_MIN_ON_US are skipped */
+#ifndef ADC_ISENSE_DELAY_CLK
+#define ADC_ISENSE_DELAY_CLK    6
+#endif
+#ifndef ADC_ISENSE_MIN_ON_US
+#define ADC_ISENSE_MIN_ON_US    8
+#endif
+
+/**
+ * @brief  Enable the ADC and its interrupt, configure the analog inputs
+ * @retval None
+ */
+void adc_sense_init(void);
+
+/**
+ * @brief  Start/arm the next scheduled conversion, called from the timebase ISR
+ * @retval None
+ */
+void adc_sense_tick(void);
+
+/**
+ * @brief  Fetch a new oversampled NTC result
+ * @param  sum: Sum of 2^ADC_NTC_OVERSAMPLE_SHIFT 12-bit conversions
+ * @retval 1 = new result since last call, 0 = none
+ * @note   Main loop only
+ */
+uint8_t adc_sense_ntc(uint16_t *sum);
+
+/**
+ * @brief  Fetch a new oversampled on-phase shunt result
+ * @param  ch: ADC_ISENSE_WHITE or ADC_ISENSE_YELLOW
+ * @param  sum: Sum of 2^ADC_ISENSE_OVERSAMPLE_SHIFT 12-bit conversions
+ * @retval 1 = new result since last call, 0 = none
+ * @note   Main loop only
+ */
+uint8_t adc_sense_isense(uint8_t ch, uint16_t *sum);
+
+#endif
@@ -0,0 +1,59 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+als.h
+
+Daylight harvesting for MS51FB9AE
+OPT3001 ambient light sensor on I2C, White duty trimmed to a target lux
+--------------------------------------------------------------------------*/
+#ifndef _ALS_H_
+#define _ALS_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "i2c.h"
+
+#define ALS_ADDR                0x44    // OPT3001, ADDR pin to GND
+
+/* Illuminance to hold at the sensor */
+#ifndef ALS_TARGET_LUX
+#define ALS_TARGET_LUX          500
+#endif
+
+#define ALS_PERIOD_MS           200     // One reading per period (100ms conversions)
+#define ALS_HYST_PCT            5       // No correction within +/- 5% of target
+#define ALS_SLEW_Q12            16      // Max gain step per period (0.4%, 2%/s)
+#define ALS_GAIN_MIN            1024    // Daylight dims White to 25% at most
+#define ALS_FAIL_MAX            5       // Failed reads before the trim is released
+
+/**
+ * @brief  Start the I2C master; the sensor is configured from als_task()
+ * @retval None
+ */
+void als_init(void);
+
+/**
+ * @brief  Poll the sensor and step the White gain towards the target
+ * @retval 1 = gain changed (re-apply the PWM), 0 = unchanged
+ * @note   Main loop only, one I2C transfer per ALS_PERIOD_MS
+ */
+uint8_t als_task(void);
+
+/**
+ * @brief  White duty gain
+ * @retval Q12, 4096 = no correction
+ */
+uint16_t als_gain(void);
+
+/**
+ * @brief  Last reading
+ * @retval Illuminance, lux (saturates at 65535)
+ */
+uint16_t als_lux(void);
+
+#endif
@@ -0,0 +1,85 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+bod_save.h
+
+Brown-out triggered last-state save for MS51FB9AE
+BOD interrupt (not reset) writes the pending state to a pre-erased slot
+--------------------------------------------------------------------------*/
+#ifndef _BOD_SAVE_H_
+#define _BOD_SAVE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+#ifndef BOD_SAVE_ENABLE
+#define BOD_SAVE_ENABLE         1
+#endif
+
+/* BODCON0 BOV[1:0] (bits 5:4) detect level */
+#define BOD_BOV_4V4             0x00
+#define BOD_BOV_3V7             0x10
+#define BOD_BOV_2V7             0x20
+#define BOD_BOV_2V2             0x30
+
+/* Board supply, mV (current_loop.h calibrates for 3.3V) */
+#ifndef BOARD_VDD_MV
+#define BOARD_VDD_MV            3300
+#endif
+
+/* Highest level the supply never dips to in normal operation */
+#ifndef BOD_LEVEL
+#define BOD_LEVEL               BOD_BOV_2V7
+#endif
+
+#if BOD_LEVEL == BOD_BOV_4V4
+#define BOD_LEVEL_MV            4400
+#elif BOD_LEVEL == BOD_BOV_3V7
+#define BOD_LEVEL_MV            3700
+#elif BOD_LEVEL == BOD_BOV_2V7
+#define BOD_LEVEL_MV            2700
+#else
+#define BOD_LEVEL_MV            2200
+#endif
+
+/* At or above VDD, BOS never clears and the save is never armed */
+#if BOD_SAVE_ENABLE && BOD_LEVEL_MV >= BOARD_VDD_MV
+#error "BOD_LEVEL must be below BOARD_VDD_MV"
+#endif
+
+/* ADDR_BOD_COST while the save is not armed */
+#define BOD_COST_UNARMED        0xFFFF
+
+/* Supply hold-up from BOD level to MCU dropout with the LEDs off, us.
+   The measured save cost (ADDR_BOD_COST) must stay below this. */
+#ifndef BOD_HOLDUP_US
+#define BOD_HOLDUP_US           500
+#endif
+
+/**
+ * @brief  Configure BOD as a top priority interrupt and time the save path
+ * @retval Measured save cost in us, 0 = no free brown-out slot
+ * @note   Call after state_store_init() and timebase_init()
+ */
+uint16_t bod_save_init(void);
+
+/**
+ * @brief  Arm the BOD interrupt once the supply is above the BOD level
+ * @retval 1 = armed by this call, 0 = unchanged
+ * @note   Main loop. Keeps a sagging supply at boot from looping the
+ *         save/reset path
+ */
+uint8_t bod_save_task(void);
+
+/**
+ * @brief  Check whether the brown-out save is armed
+ * @retval 1 = armed, 0 = supply not above the BOD level yet
+ */
+uint8_t bod_save_armed(void);
+
+#endif
@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+boot_trace.h
+
+Boot time trace for MS51FB9AE
+Reset-to-light and reset-to-display-synced timestamps
+--------------------------------------------------------------------------*/
+#ifndef _BOOT_TRACE_H_
+#define _BOOT_TRACE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+#ifndef BOOT_TRACE_ENABLE
+#define BOOT_TRACE_ENABLE       1
+#endif
+
+/* Light stamps are taken until this tick: Timer2 wraps at 43.69ms */
+#define BOOT_TRACE_WINDOW_MS    44
+
+#define BOOT_TRACE_NONE         0xFFFF
+
+/**
+ * @brief  Stamp the first non-zero PWM output
+ * @retval None
+ * @note   Timebase ISR context (led_fade_tick). Only the first call counts
+ */
+void boot_trace_light(void);
+
+/**
+ * @brief  End the light stamp window
+ * @retval None
+ * @note   Timebase ISR context, at tick BOOT_TRACE_WINDOW_MS
+ */
+void boot_trace_close(void);
+
+/**
+ * @brief  Stamp the end of the boot display sync
+ * @retval None
+ * @note   Main loop, once the sync frames have left the UART
+ */
+void boot_trace_synced(void);
+
+/**
+ * @brief  timebase_init-to-light time
+ * @retval us, BOOT_TRACE_NONE = light not on within BOOT_TRACE_WINDOW_MS
+ */
+uint16_t boot_trace_light_us(void);
+
+/**
+ * @brief  timebase_init-to-display-synced time
+ * @retval ms, BOOT_TRACE_NONE = not synced yet
+ */
+uint16_t boot_trace_sync_ms(void);
+
+#endif
@@ -0,0 +1,55 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+bus_link.h
+
+Multi-drop controller bus on UART1 (RS-485) for MS51FB9AE
+One master broadcasts its state, slaves follow and forward local changes
+--------------------------------------------------------------------------*/
+#ifndef _BUS_LINK_H_
+#define _BUS_LINK_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "state_store.h"
+
+/* 0 = master, 1..BUS_NODE_MAX = slave */
+#ifndef BUS_NODE_ADDR
+#define BUS_NODE_ADDR           0
+#endif
+
+#define BUS_NODE_MAX            8
+#define BUS_ADDR_MASTER         0
+#define BUS_ADDR_BROADCAST      0xFF
+
+#ifndef BUS_BAUD
+#define BUS_BAUD                19200
+#endif
+
+/* Master: state refresh for late joiners when nothing changes */
+#define BUS_REFRESH_MS          500
+/* Reply slot per slave after each master frame (one frame + turnaround) */
+#define BUS_SLOT_MS             12
+/* Slave: no master frame for this long = run standalone */
+#define BUS_MASTER_TIMEOUT_MS   (3 * BUS_REFRESH_MS)
+
+/**
+ * @brief  Start UART1 at BUS_BAUD, listening
+ * @retval None
+ */
+void bus_link_init(void);
+
+/**
+ * @brief  Receive frames, broadcast or forward state changes
+ * @param  st: In: live local state. Out: state to apply if 1 is returned
+ * @retval 1 = another node changed the state, apply *st
+ * @note   Main loop only
+ */
+uint8_t bus_link_task(State_t *st);
+
+#endif
@@ -0,0 +1,74 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+cam_sync.h
+
+Camera frame-sync PWM phase lock for MS51FB9AE
+Frame pulse on P0.1 (pin interrupt channel 1, rising edge)
+--------------------------------------------------------------------------*/
+#ifndef _CAM_SYNC_H_
+#define _CAM_SYNC_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Set to 0 on boards where P0.1 is not wired to a camera sync output */
+#ifndef CAM_SYNC_ENABLE
+#define CAM_SYNC_ENABLE         1
+#endif
+
+#define CAM_SYNC_PIF            0x02    // PIF bit for P0.1
+
+/* Accepted frame period: 15ms (66fps) .. 43ms (23fps, timestamp limit) */
+#define CAM_SYNC_FRAME_MIN      (15 * 1500)
+#define CAM_SYNC_FRAME_MAX      (43 * 1500)
+
+#define CAM_SYNC_TIMEOUT_MS     100     // No pulse -> back to free running
+#define CAM_SYNC_LOCK_FRAMES    8       // Frames within tolerance to report lock
+#define CAM_SYNC_LOCK_TOL       8       // Phase tolerance, PWM clocks
+
+typedef enum
+{
+    CAM_SYNC_OFF = 0,   // Disarmed, PWM free running
+    CAM_SYNC_FREE,      // Armed, no valid sync or 43K profile: PWM free running
+    CAM_SYNC_TRACKING,  // Pulling period/phase onto the frame rate
+    CAM_SYNC_LOCKED,    // Phase error within tolerance
+} CAM_Sync_State_t;
+
+/**
+ * @brief  Configure P0.1 as frame-sync input (disarmed)
+ * @retval None
+ */
+void cam_sync_init(void);
+
+/**
+ * @brief  Arm or disarm phase locking
+ * @param  enable: 1 = lock PWM to frame pulses when present
+ * @retval None
+ */
+void cam_sync_arm(uint8_t enable);
+
+/**
+ * @brief  Frame edge handler, called from the pin interrupt ISR
+ * @retval None
+ */
+void cam_sync_edge(void);
+
+/**
+ * @brief  Software PLL update, call from the main loop
+ * @retval None
+ */
+void cam_sync_task(void);
+
+/**
+ * @brief  Get sync state
+ * @retval CAM_Sync_State_t
+ */
+CAM_Sync_State_t cam_sync_state(void);
+
+#endif
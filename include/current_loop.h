@@ -0,0 +1,61 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+current_loop.h
+
+Closed-loop LED current regulation for MS51FB9AE
+Per-channel PI on the on-phase shunt current, output = duty gain (Q12)
+--------------------------------------------------------------------------*/
+#ifndef _CURRENT_LOOP_H_
+#define _CURRENT_LOOP_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "adc_sense.h"
+
+#define CURRENT_GAIN_ONE        4096    // Q12: 1.0
+
+/*
+ * Reference on-current per channel as a 12-bit ADC reading of the shunt
+ * (VDD reference): I_nom x R_shunt / VDD x 4095. Calibrate so that the
+ * reference unit gives the nominal lumen level per brightness step.
+ * Default: 1A x 0.1R at 3.3V = 124
+ */
+#ifndef CURRENT_REF_WHITE_ADC
+#define CURRENT_REF_WHITE_ADC   124
+#endif
+#ifndef CURRENT_REF_YELLOW_ADC
+#define CURRENT_REF_YELLOW_ADC  124
+#endif
+
+/* Correction authority: gain stays within 1.0 +/- this (Q12, 1024 = 25%) */
+#ifndef CURRENT_TRIM_MAX
+#define CURRENT_TRIM_MAX        1024
+#endif
+
+/**
+ * @brief  Reset both loops to unity gain
+ * @retval None
+ */
+void current_loop_init(void);
+
+/**
+ * @brief  Run the PI update for channels with a new shunt result
+ * @retval 1 = a gain moved by more than the deadband, re-apply the duty
+ * @note   Main loop
+ */
+uint8_t current_loop_task(void);
+
+/**
+ * @brief  Get duty correction for a channel
+ * @param  ch: ADC_ISENSE_WHITE or ADC_ISENSE_YELLOW
+ * @retval Gain, Q12 (CURRENT_GAIN_ONE = no correction)
+ */
+uint16_t current_loop_gain(uint8_t ch);
+
+#endif
@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+dmx.h
+
+DMX512 receiver on UART1 (RS-485) for MS51FB9AE
+250 kbaud 9-bit framing, break detected by the framing error flag
+--------------------------------------------------------------------------*/
+#ifndef _DMX_H_
+#define _DMX_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "uart1.h"
+
+/* First slot of this fixture, 1-512 */
+#ifndef DMX_START_ADDR
+#define DMX_START_ADDR          1
+#endif
+
+/* Slots used from DMX_START_ADDR on */
+#define DMX_CH_INTENSITY        0       // 0-255 = off .. brightest level
+#define DMX_CH_CCT              1       // 0-255 = all White .. all Yellow
+#define DMX_CHANNELS            2
+
+#if DMX_START_ADDR < 1 || DMX_START_ADDR + DMX_CHANNELS - 1 > 512
+#error "DMX_START_ADDR out of range"
+#endif
+
+#define DMX_BAUD                250000
+
+/* No complete packet for this long: back to local control */
+#ifndef DMX_TIMEOUT_MS
+#define DMX_TIMEOUT_MS          1000
+#endif
+
+/* dmx_task() results */
+#define DMX_NONE                0
+#define DMX_FRAME               1       // New levels
+#define DMX_LOST                2       // Signal gone (reported once)
+
+/**
+ * @brief  Start UART1 at 250 kbaud 9-bit with framing error reporting
+ * @retval None
+ * @note   P0.0 is held low: the transceiver only receives
+ */
+void dmx_init(void);
+
+/**
+ * @brief  Collect the last complete packet
+ * @param  levels: DMX_CHANNELS slot values, written on DMX_FRAME
+ * @retval DMX_NONE, DMX_FRAME or DMX_LOST
+ * @note   Main loop only
+ */
+uint8_t dmx_task(uint8_t *levels);
+
+#endif
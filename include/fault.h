@@ -0,0 +1,67 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+fault.h
+
+LED overcurrent fault brake for MS51FB9AE
+ADC compare on the shunt samples asserts the PWM fault brake in hardware
+--------------------------------------------------------------------------*/
+#ifndef _FAULT_H_
+#define _FAULT_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "Common.h"
+#include "adc_sense.h"
+
+/* Needs the shunt inputs; the FB pin itself is P1.4 (White PWM) */
+#ifndef FAULT_BRAKE_ENABLE
+#define FAULT_BRAKE_ENABLE      ADC_ISENSE_ENABLE
+#endif
+
+/* Trip level per channel, 12-bit shunt reading (default 2x nominal) */
+#ifndef FAULT_TRIP_WHITE_ADC
+#define FAULT_TRIP_WHITE_ADC    248
+#endif
+#ifndef FAULT_TRIP_YELLOW_ADC
+#define FAULT_TRIP_YELLOW_ADC   248
+#endif
+
+/* Fault codes (DWIN ADDR_FAULT) */
+#define FAULT_NONE              0
+#define FAULT_OVERCURRENT       1
+
+/**
+ * @brief  Set brake output levels and enable the fault brake interrupt
+ * @retval None
+ * @note   Compare thresholds are loaded per shunt slot by adc_sense.c
+ */
+void fault_init(void);
+
+/**
+ * @brief  Report a newly latched fault once
+ * @retval Fault code of a new latch, FAULT_NONE otherwise
+ * @note   Main loop
+ */
+uint8_t fault_task(void);
+
+/**
+ * @brief  Get latched fault
+ * @retval FAULT_xxx
+ */
+uint8_t fault_code(void);
+
+/**
+ * @brief  Release the latch and the output pins
+ * @retval 1 if a fault was cleared, 0 if none was latched
+ * @note   Main loop. PWM is stopped by the brake: the caller restarts it
+ *         through the profile/soft-start path
+ */
+uint8_t fault_clear(void);
+
+#endif
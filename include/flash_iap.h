@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+flash_iap.h
+
+APROM data storage via IAP for MS51FB9AE
+The top 1KB of APROM is reserved for data (IROM size in the project
+files ends at FLASH_DATA_BASE)
+--------------------------------------------------------------------------*/
+#ifndef _FLASH_IAP_H_
+#define _FLASH_IAP_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+#define FLASH_PAGE_SIZE         128
+
+/* Data area map (128-byte pages) */
+#define FLASH_DATA_BASE         0x3C00
+#define FLASH_DATA_END          0x4000
+#define FLASH_PRESET_PAGE       0x3C00
+#define FLASH_STATE_PAGE0       0x3C80  // State log, ping-pong pages
+#define FLASH_STATE_PAGE1       0x3D00
+#define FLASH_BOD_PAGE          0x3D80  // Brown-out save slots, kept erased
+
+/* IAPCN commands */
+#define IAP_APROM_READ          0x00
+#define IAP_APROM_PROGRAM       0x21
+#define IAP_APROM_ERASE         0x22
+
+/* Read data flash through MOVC, any context */
+#define FLASH_READ(addr)        (*((uint8_t code *)(addr)))
+
+/*
+ * Raw IAP access for contexts that must not call into this module
+ * (ISRs). Caller runs with EA = 0; the CPU halts until the operation ends.
+ */
+#define FLASH_IAP_ENABLE()      TA = 0xAA; TA = 0x55; CHPCON |= 0x01;          \
+                                TA = 0xAA; TA = 0x55; IAPUEN |= 0x01
+#define FLASH_IAP_DISABLE()     TA = 0xAA; TA = 0x55; IAPUEN &= ~0x01;         \
+                                TA = 0xAA; TA = 0x55; CHPCON &= ~0x01
+#define FLASH_IAP_GO(cmd, addr, dat)                                           \
+                                IAPCN = (cmd);                                 \
+                                IAPAH = (uint8_t)((addr) >> 8);                \
+                                IAPAL = (uint8_t)(addr);                       \
+                                IAPFD = (dat);                                 \
+                                TA = 0xAA; TA = 0x55; IAPTRG |= 0x01
+
+/**
+ * @brief  Erase one data page (~5ms, CPU stalled)
+ * @param  page: Page start address inside the data area
+ * @retval 1 = ok, 0 = address outside the data area or IAP fail
+ * @note   Main loop only
+ */
+uint8_t flash_iap_erase(uint16_t page);
+
+/**
+ * @brief  Program bytes into erased data flash
+ * @param  addr: Start address inside the data area
+ * @param  src: Source bytes
+ * @param  len: Byte count
+ * @retval 1 = ok, 0 = address outside the data area or IAP fail
+ * @note   Main loop only; interrupts are masked one byte at a time
+ */
+uint8_t flash_iap_write(uint16_t addr, uint8_t *src, uint8_t len);
+
+#endif
@@ -0,0 +1,71 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+i2c.h
+
+I2C port mode + interrupt-driven master with a transaction queue for MS51FB9AE
+SCL P0.2, SDA P1.6 (I2CPX = 1; the default SDA pin P1.4 is the White PWM)
+--------------------------------------------------------------------------*/
+#ifndef _I2C_H_
+#define _I2C_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "uart1.h"
+
+/* What runs on the I2C port */
+#define I2C_MODE_NONE           0
+#define I2C_MODE_ALS            1       // Master polling the ambient sensor, als.c
+#define I2C_MODE_SLAVE          2       // Register interface for a host board, i2c_slave.c
+
+#ifndef I2C_MODE
+#define I2C_MODE                I2C_MODE_NONE
+#endif
+
+/* The alternate I2C pins are the UART1 pins: one or the other */
+#if I2C_MODE != I2C_MODE_NONE && UART1_MODE != UART1_MODE_NONE
+#error "I2C uses P0.2/P1.6 (TXD_1/RXD_1): build with UART1_MODE=UART1_MODE_NONE"
+#endif
+
+/* SCL = Fsys / (4 x (I2CLK + 1)): 59 = 100kHz */
+#define I2C_CLOCK_DIV           59
+
+#define I2C_QUEUE_LEN           4       // Power of 2
+#define I2C_XFER_MAX            4       // Bytes per transfer, write or read
+
+/* I2C_Xfer_t.status */
+#define I2C_IDLE                0       // Not queued / result taken
+#define I2C_PENDING             1       // Queued or on the bus
+#define I2C_DONE                2
+#define I2C_ERROR               3       // NACK, arbitration lost, bus error or timeout
+
+/* Write wr_len bytes of buf, then (repeated START) read rd_len bytes into buf */
+typedef struct
+{
+    uint8_t addr;           // 7-bit slave address
+    uint8_t wr_len;
+    uint8_t rd_len;
+    volatile uint8_t status;
+    uint8_t buf[I2C_XFER_MAX];
+} I2C_Xfer_t;
+
+/**
+ * @brief  Enable the I2C master on the alternate pins
+ * @retval None
+ * @note   SCL/SDA need external pull-ups
+ */
+void i2c_init(void);
+
+/**
+ * @brief  Queue a transfer, started at once if the bus is free
+ * @param  x: Transfer, owned by the caller until status leaves I2C_PENDING
+ * @retval 1 = queued, 0 = queue full
+ */
+uint8_t i2c_submit(I2C_Xfer_t xdata *x);
+
+#endif
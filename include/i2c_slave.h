@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+i2c_slave.h
+
+I2C slave register interface for a host board on MS51FB9AE
+Byte registers with auto-increment; SCL P0.2, SDA P1.6 (I2CPX = 1)
+--------------------------------------------------------------------------*/
+#ifndef _I2C_SLAVE_H_
+#define _I2C_SLAVE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "i2c.h"
+
+/* 7-bit slave address */
+#ifndef I2CS_ADDR
+#define I2CS_ADDR               0x2A
+#endif
+
+/* Registers */
+#define I2CS_REG_POWER          0x00    // R/W  0 = off, 1 = on
+#define I2CS_REG_BRIGHT         0x01    // R/W  Brightness level 0-10
+#define I2CS_REG_CCT            0x02    // R/W  CCT level 0-10
+#define I2CS_REG_PROFILE        0x03    // R/W  PWM profile, LED_PWM_PROFILE_xxx
+#define I2CS_REG_RECALL         0x04    // W    PRESET_xxx + 1 recalls, reads 0
+#define I2CS_REG_STORE          0x05    // W    PRESET_xxx + 1 stores, reads 0
+#define I2CS_REG_FAULT          0x06    // R/W  Fault code, write 0 to clear
+#define I2CS_REG_STATUS         0x07    // R    I2CS_STATUS_xxx
+#define I2CS_REG_TEMP           0x08    // R    Heatsink, deg C (0 without NTC)
+#define I2CS_REG_RESET          0x09    // R    Reset cause, RESET_xxx
+#define I2CS_REG_WDT_MISSES     0x0A    // R    Watchdog task misses
+#define I2CS_REG_WRITES         0x0B    // R    Write bursts applied (wraps)
+#define I2CS_REG_REJECTS        0x0C    // R    Write bursts rejected (wraps)
+#define I2CS_REG_COUNT          0x0D
+
+/* I2CS_REG_STATUS bits */
+#define I2CS_STATUS_LIT         0x01    // Output on or ramping up
+#define I2CS_STATUS_FAULT       0x02    // Overcurrent brake latched
+#define I2CS_STATUS_DERATED     0x04    // Thermal derating active
+#define I2CS_STATUS_DISPLAY     0x08    // DWIN panel answering
+
+#define I2CS_LEVEL_MAX          10
+#define I2CS_BIT(reg)           ((uint16_t)1 << (reg))
+
+/**
+ * @brief  Enable the I2C slave at I2CS_ADDR on the alternate pins
+ * @retval None
+ */
+void i2c_slave_init(void);
+
+/**
+ * @brief  Set a register in the snapshot being prepared
+ * @param  reg: I2CS_REG_xxx
+ * @param  value: Current value
+ * @retval None
+ * @note   Not visible to the host before i2c_slave_publish()
+ */
+void i2c_slave_set(uint8_t reg, uint8_t value);
+
+/**
+ * @brief  Make the prepared snapshot the one the host reads
+ * @retval None
+ * @note   Deferred to the next call while a read burst is running
+ */
+void i2c_slave_publish(void);
+
+/**
+ * @brief  Validate and take over the last write burst
+ * @retval I2CS_BIT() mask of registers written, 0 = none or rejected
+ * @note   Main loop only; all registers of a burst arrive in one call
+ */
+uint16_t i2c_slave_task(void);
+
+/**
+ * @brief  Value written by the host
+ * @param  reg: I2CS_REG_xxx from the mask of i2c_slave_task()
+ * @retval Register value
+ */
+uint8_t i2c_slave_get(uint8_t reg);
+
+#endif
@@ -42,6 +42,19 @@ void ir_rx_setup(IR_Type_t ir_type);
  */
 uint8_t is_ir_data_received(void);
 
+/**
+ * @brief  Check for a frame being received
+ * @retval 1 from the leader to the last bit, 0 otherwise (also after
+ *         32ms without an edge: abandoned frame)
+ */
+uint8_t is_ir_busy(void);
+
+/**
+ * @brief  Check for an NEC repeat frame (key held, sent every 108ms)
+ * @retval 1 if a repeat arrived since the last call, 0 otherwise
+ */
+uint8_t is_ir_repeat(void);
+
 /**
  * @brief  Get the received IR data
  * @param  buf: Buffer to store received data
@@ -0,0 +1,81 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+led_fade.h
+
+Background slew-limited duty ramps for MS51FB9AE
+Stepped every 1ms from the timebase ISR, drives led_pwm_set()
+--------------------------------------------------------------------------*/
+#ifndef _LED_FADE_H_
+#define _LED_FADE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Ramp times (ms) - override per product build */
+#ifndef LED_FADE_POWER_MS
+#define LED_FADE_POWER_MS       600     // Power on/off ramp
+#endif
+#ifndef LED_FADE_STEP_MS
+#define LED_FADE_STEP_MS        150     // Brightness/CCT change
+#endif
+#ifndef LED_FADE_STAGGER_MS
+#define LED_FADE_STAGGER_MS     150     // Yellow start delay at power on
+#endif
+
+/* Slew limit: no ramp faster than 0..100% in this time (inrush cap) */
+#ifndef LED_FADE_SLEW_MS
+#define LED_FADE_SLEW_MS        200
+#endif
+
+/**
+ * @brief  Reset both channels to dark, no ramp running
+ * @retval None
+ */
+void led_fade_init(void);
+
+/**
+ * @brief  Start a ramp from the current output to new duties
+ * @param  white: White target duty (led_pwm_set units)
+ * @param  yellow: Yellow target duty (led_pwm_set units)
+ * @param  ramp_ms: Ramp duration, 0 = as fast as the slew limit allows
+ * @param  stagger_ms: Yellow start delay after White
+ * @retval None
+ * @note   Main loop only. A new call retargets a running ramp smoothly
+ */
+void led_fade_to(uint16_t white, uint16_t yellow, uint16_t ramp_ms, uint16_t stagger_ms);
+
+/**
+ * @brief  Set new duties on the next tick, no ramp and no slew limit
+ * @param  white: White duty (led_pwm_set units)
+ * @param  yellow: Yellow duty (led_pwm_set units)
+ * @retval None
+ * @note   Main loop only. Warm restart: the light was on before the reset
+ */
+void led_fade_jump(uint16_t white, uint16_t yellow);
+
+/**
+ * @brief  Forget the current output after the PWM stage forced it to 0
+ * @retval None
+ * @note   Main loop only (profile switch); next led_fade_to ramps from dark
+ */
+void led_fade_reset(void);
+
+/**
+ * @brief  Check for a running ramp
+ * @retval 1 = ramping or waiting on stagger, 0 = at target
+ */
+uint8_t led_fade_busy(void);
+
+/**
+ * @brief  Advance the ramps by 1ms, called from the timebase ISR
+ * @retval None
+ */
+void led_fade_tick(void);
+
+#endif
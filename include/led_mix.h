@@ -0,0 +1,80 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+led_mix.h
+
+Constant-lumen White/Yellow CCT mixing model for MS51FB9AE
+Maps (intensity, CCT) to both channel duties in fixed point
+--------------------------------------------------------------------------*/
+#ifndef _LED_MIX_H_
+#define _LED_MIX_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/*
+ * Fixed-point conventions:
+ * - Intensity is total flux in white-equivalent duty counts
+ *   (1 count = light of one white PWM count at gain 1.0)
+ * - Warm share (CCT) is Q7: 0 = all white, MIX_WARM_FULL = all yellow
+ * - Gain/power calibration factors are Q7: 128 = 1.0, max 255 (~1.99)
+ * - The power budget is Q7 in 16 bits: 256 = 2.0, both channels at full duty
+ */
+#define MIX_Q7_ONE          128
+#define MIX_WARM_FULL       MIX_Q7_ONE
+
+/*
+ * Per-channel calibration (override per product build)
+ * GAIN:  duty counts needed per unit of flux (measure lux per count,
+ *        normalise to the brighter channel)
+ * POWER: driver power per duty count, relative to the white channel
+ * LIMIT: combined power budget in units of one channel at full duty,
+ *        default both channels at full duty (the original Max setting)
+ */
+#ifndef MIX_GAIN_WHITE_Q7
+#define MIX_GAIN_WHITE_Q7   128     /* 1.00 */
+#endif
+#ifndef MIX_GAIN_YELLOW_Q7
+#define MIX_GAIN_YELLOW_Q7  128     /* 1.00 */
+#endif
+#ifndef MIX_POWER_WHITE_Q7
+#define MIX_POWER_WHITE_Q7  128     /* 1.00 */
+#endif
+#ifndef MIX_POWER_YELLOW_Q7
+#define MIX_POWER_YELLOW_Q7 128     /* 1.00 */
+#endif
+#ifndef MIX_POWER_LIMIT_Q7
+#define MIX_POWER_LIMIT_Q7  256     /* 2.00 x one channel at full duty */
+#endif
+
+typedef struct
+{
+    uint16_t white;     // White channel duty (PWM counts)
+    uint16_t yellow;    // Yellow channel duty (PWM counts)
+} LED_Duty_t;
+
+/**
+ * @brief  Set channel full-scale duty and reset the cached blend
+ * @param  full_scale: PWM count for 100% duty on one channel
+ * @retval None
+ */
+void led_mix_init(uint16_t full_scale);
+
+/**
+ * @brief  Split total flux into White/Yellow duties at constant lumen
+ * @param  intensity: Total flux (white-equivalent counts)
+ * @param  warm: Yellow share, Q7 (0..MIX_WARM_FULL)
+ * @param  out: Resulting channel duties
+ * @retval None
+ * @note   Blend coefficients and the intensity ceiling are cached per
+ *         warm value, so an intensity-only update costs two 16x8
+ *         multiplies and a compare (no division)
+ */
+void led_mix_compute(uint16_t intensity, uint8_t warm, LED_Duty_t *out);
+
+#endif
@@ -0,0 +1,189 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+led_pwm.h
+
+White (PWM1/P1.4) and Yellow (PWM5/P1.5) LED PWM output stage for MS51FB9AE
+Duties are given in sub-count fixed point; optional temporal dithering
+--------------------------------------------------------------------------*/
+#ifndef _LED_PWM_H_
+#define _LED_PWM_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "Common.h"
+
+/*
+ * PWM profiles (frequency vs. resolution), Fsys = 24MHz
+ *   2K7: /8, period 1110 -> 2.70kHz, 10.1 bit (legacy)
+ *   21K: /1, period 1142 -> 21.0kHz, 10.2 bit (camera safe)
+ *   43K: /1, period  557 -> 43.0kHz,  9.1 bit (high-speed camera safe,
+ *        no dithering or period stamping: the period ISR would cost
+ *        ~25% CPU)
+ */
+#define LED_PWM_PROFILE_2K7     0
+#define LED_PWM_PROFILE_21K     1
+#define LED_PWM_PROFILE_43K     2
+#define LED_PWM_PROFILE_COUNT   3
+
+#ifndef LED_PWM_PROFILE_DEFAULT
+#define LED_PWM_PROFILE_DEFAULT LED_PWM_PROFILE_2K7
+#endif
+
+/* Duty fixed point: PWM counts << LED_DUTY_FRAC_BITS */
+#define LED_DUTY_FRAC_BITS      4
+#define LED_DUTY_FRAC_MASK      ((1 << LED_DUTY_FRAC_BITS) - 1)
+
+/* Dithering enabled at boot (1) or only on request (0) */
+#ifndef LED_DITHER_DEFAULT
+#define LED_DITHER_DEFAULT      1
+#endif
+
+/* White/Yellow conduction interleaved at boot (1) or in phase (0) */
+#ifndef LED_INTERLEAVE_DEFAULT
+#define LED_INTERLEAVE_DEFAULT  1
+#endif
+
+/* Mirror White/Yellow compare values on PWM0/PWM4 (no pin output): the
+   ADC can only be triggered by PWM0/2/4, see adc_sense.c */
+#ifndef LED_PWM_ADC_MIRROR
+#define LED_PWM_ADC_MIRROR      1
+#endif
+
+/* Clock shift of the active profile for interrupt context: a variable,
+   so the ISR call tree shares no function with the main loop */
+extern volatile uint8_t data g_led_pwm_shift;
+#define LED_PWM_CLOCK_SHIFT()   (g_led_pwm_shift)
+
+/**
+ * @brief  Configure PWM1/PWM5 (edge aligned, independent) and start PWM
+ *         with LED_PWM_PROFILE_DEFAULT
+ * @retval None
+ */
+void led_pwm_init(void);
+
+/**
+ * @brief  Switch PWM clock divider and period to another profile
+ * @param  profile: LED_PWM_PROFILE_xxx
+ * @retval 1 if applied, 0 if profile is invalid
+ * @note   Duties are cleared; the caller must rescale its dimming LUT
+ *         to led_pwm_full_scale() and set new duties
+ */
+uint8_t led_pwm_profile(uint8_t profile);
+
+/**
+ * @brief  Get the active profile
+ * @retval LED_PWM_PROFILE_xxx
+ */
+uint8_t led_pwm_get_profile(void);
+
+/**
+ * @brief  Get 100% duty of the active profile
+ * @retval Full-scale duty, PWM counts << LED_DUTY_FRAC_BITS
+ */
+uint16_t led_pwm_full_scale(void);
+
+/**
+ * @brief  Get nominal period of the active profile
+ * @retval PWMP value (PWM clocks per period - 1)
+ */
+uint16_t led_pwm_period(void);
+
+/**
+ * @brief  Get PWM clock divider of the active profile as a shift
+ * @retval log2(divider): PWM clock = Fsys >> shift
+ * @note   Main loop only; ISRs use LED_PWM_CLOCK_SHIFT()
+ */
+uint8_t led_pwm_clock_shift(void);
+
+/**
+ * @brief  Trim the running period (loaded at the next period boundary)
+ * @param  period: PWMP value, 0 = restore profile nominal
+ * @retval None
+ * @note   Duty counts are not rescaled; intended for small trims only
+ */
+void led_pwm_trim_period(uint16_t period);
+
+/**
+ * @brief  Timestamp every period boundary with the timebase counter
+ * @param  enable: 1 = run the period ISR and record led_pwm_period_stamp()
+ * @retval None
+ * @note   Held back while the active profile cannot afford the period ISR
+ *         (43K), see led_pwm_stamping()
+ */
+void led_pwm_stamp(uint8_t enable);
+
+/**
+ * @brief  Check whether period boundaries are being stamped
+ * @retval 1 = requested and allowed by the active profile
+ */
+uint8_t led_pwm_stamping(void);
+
+/**
+ * @brief  Timebase ticks at the most recent period boundary
+ * @retval Timer2 timestamp
+ * @note   Interrupt context only (same priority as the PWM interrupt)
+ */
+uint16_t led_pwm_period_stamp(void);
+
+/**
+ * @brief  Set both channel duties
+ * @param  white: White duty, PWM counts << LED_DUTY_FRAC_BITS
+ * @param  yellow: Yellow duty, PWM counts << LED_DUTY_FRAC_BITS
+ * @retval None
+ * @note   With dithering off the fraction is rounded to the nearest count.
+ *         Timebase ISR context only: duties are driven by led_fade.c
+ */
+void led_pwm_set(uint16_t white, uint16_t yellow);
+
+/**
+ * @brief  Interleave the Yellow on-time with the White on-time
+ * @param  enable: 1 = White on at period start, Yellow on at period end
+ * @retval None
+ * @note   While White + Yellow duty <= 100% the two LED currents never
+ *         overlap, so supply peak current is the larger channel, not
+ *         the sum of both
+ */
+void led_pwm_interleave(uint8_t enable);
+
+/**
+ * @brief  Get interleave state
+ * @retval 1 = Yellow conducts at the end of the period (PWM4 mirror falls
+ *         when Yellow turns on), 0 = both start at period start
+ */
+uint8_t led_pwm_interleaved(void);
+
+/**
+ * @brief  Get integer duty counts currently staged per channel
+ * @retval PWM counts (no fraction)
+ * @note   Timebase ISR context only: used to skip on-phase ADC samples
+ *         of short pulses. The main loop uses led_pwm_counts()
+ */
+uint16_t led_pwm_counts_white(void);
+uint16_t led_pwm_counts_yellow(void);
+
+/**
+ * @brief  Consistent snapshot of both staged duty counts
+ * @param  white: White PWM counts
+ * @param  yellow: Yellow PWM counts
+ * @retval None
+ * @note   Main loop only (masks the timebase tick while reading)
+ */
+void led_pwm_counts(uint16_t *white, uint16_t *yellow);
+
+/**
+ * @brief  Enable/disable sigma-delta dithering of the duty fraction
+ * @param  enable: 1 = alternate adjacent counts per PWM period
+ * @retval None
+ * @note   Adds LED_DUTY_FRAC_BITS of effective resolution at the same
+ *         PWM frequency, at the cost of one short ISR per period.
+ *         Ignored while the active profile does not allow dithering
+ */
+void led_pwm_dither(uint8_t enable);
+
+#endif
@@ -0,0 +1,83 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+modbus.h
+
+Modbus RTU slave on UART1 (RS-485) for MS51FB9AE
+Function codes 03 / 06 / 16 on a small holding register map
+--------------------------------------------------------------------------*/
+#ifndef _MODBUS_H_
+#define _MODBUS_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "uart1.h"
+
+#ifndef MODBUS_ADDR
+#define MODBUS_ADDR             1       // Slave address 1-247
+#endif
+#ifndef MODBUS_BAUD
+#define MODBUS_BAUD             19200
+#endif
+#ifndef MODBUS_PARITY
+#define MODBUS_PARITY           UART1_PARITY_EVEN
+#endif
+
+#define MODBUS_BROADCAST        0
+
+/* 3.5 character times (11 bit characters), fixed 1.75ms above 19200 baud */
+#if MODBUS_BAUD > 19200
+#define MODBUS_T35_US           1750
+#else
+#define MODBUS_T35_US           (38500000UL / MODBUS_BAUD)
+#endif
+/* Idle ticks that guarantee t3.5 (a count of n is at least n-1 ms) */
+#define MODBUS_T35_TICKS        ((MODBUS_T35_US + 999) / 1000 + 1)
+
+/* Holding registers (PDU address) */
+#define MB_REG_POWER            0       // 0 = off, 1 = on
+#define MB_REG_BRIGHT           1       // Brightness level 0-10
+#define MB_REG_CCT              2       // CCT level 0-10
+#define MB_REG_PROFILE          3       // PWM profile, LED_PWM_PROFILE_xxx
+#define MB_REG_RECALL           4       // Write PRESET_xxx + 1 to recall, reads 0
+#define MB_REG_STORE            5       // Write PRESET_xxx + 1 to store, reads 0
+#define MB_REG_FAULT            6       // Fault code, write 0 to clear
+#define MB_REG_COUNT            7
+
+#define MB_LEVEL_MAX            10
+#define MB_BIT(reg)             (1 << (reg))
+
+/**
+ * @brief  Start UART1 at MODBUS_BAUD / MODBUS_PARITY, listening
+ * @retval None
+ */
+void modbus_init(void);
+
+/**
+ * @brief  Update a register as seen by the master
+ * @param  reg: MB_REG_xxx
+ * @param  value: Current value
+ * @retval None
+ */
+void modbus_set(uint8_t reg, uint16_t value);
+
+/**
+ * @brief  Value written by the master
+ * @param  reg: MB_REG_xxx
+ * @retval Register value
+ */
+uint16_t modbus_get(uint8_t reg);
+
+/**
+ * @brief  Handle one request once the t3.5 gap has passed
+ * @retval MB_BIT() mask of registers the master wrote, 0 = none
+ * @note   Main loop only; refresh the registers with modbus_set() first
+ */
+uint8_t modbus_task(void);
+
+#endif
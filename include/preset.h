@@ -0,0 +1,57 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+preset.h
+
+Lighting presets for MS51FB9AE
+Factory table in code memory, site-stored copies in the data flash page
+--------------------------------------------------------------------------*/
+#ifndef _PRESET_H_
+#define _PRESET_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+#define PRESET_ENDO             0
+#define PRESET_MEM1             1
+#define PRESET_MEM2             2
+#define PRESET_MAX              3
+#define PRESET_COUNT            4
+
+typedef struct
+{
+    uint8_t brightness;     // 0..MAX_BRIGHTNESS
+    uint8_t cct;            // 0..MAX_CCT
+    uint16_t fade_ms;       // Recall ramp time
+} Preset_t;
+
+/**
+ * @brief  Load stored presets, factory table if none are valid
+ * @retval None
+ */
+void preset_init(void);
+
+/**
+ * @brief  Look up a preset
+ * @param  idx: PRESET_xxx
+ * @param  out: Preset copy
+ * @retval 1 = ok, 0 = invalid index
+ */
+uint8_t preset_get(uint8_t idx, Preset_t *out);
+
+/**
+ * @brief  Store a new brightness/CCT into a preset (fade time kept)
+ * @param  idx: PRESET_xxx
+ * @param  brightness: Level to store
+ * @param  cct: CCT to store
+ * @retval 1 = stored, 0 = invalid index or flash failure
+ * @note   Main loop; rewrites the preset page (~5ms CPU stall)
+ */
+uint8_t preset_store(uint8_t idx, uint8_t brightness, uint8_t cct);
+
+#endif
@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+state_store.h
+
+Wear-leveled persistent state for MS51FB9AE
+Append-only record log on two data flash pages, RAM write-back cache
+--------------------------------------------------------------------------*/
+#ifndef _STATE_STORE_H_
+#define _STATE_STORE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Commit once the state has been stable this long */
+#ifndef STATE_COMMIT_DELAY_MS
+#define STATE_COMMIT_DELAY_MS   2000
+#endif
+
+typedef struct
+{
+    uint8_t power;
+    uint8_t brightness;
+    uint8_t cct;
+    uint8_t profile;        // LED_PWM_PROFILE_xxx
+} State_t;
+
+/**
+ * @brief  Scan the log and load the newest valid record
+ * @param  out: Restored state (untouched if none found)
+ * @retval 1 = state restored, 0 = empty or corrupt log
+ */
+uint8_t state_store_init(State_t *out);
+
+/**
+ * @brief  Update the cached state
+ * @param  st: Current state
+ * @retval None
+ * @note   Cheap compare, call every main loop pass; flash is written
+ *         later by state_store_task()
+ */
+void state_store_set(State_t *st);
+
+/**
+ * @brief  Write the precomputed record to the pre-erased brown-out slot
+ * @retval None
+ * @note   BOD ISR only (EA = 0): raw IAP, 8 byte programs, no erase
+ */
+void state_store_bod_commit(void);
+
+/**
+ * @brief  Time the brown-out commit path without consuming the slot
+ * @retval Timebase ticks (0.667us) for 8 byte programs, 0 = no free slot
+ * @note   Main loop; programs 0xFF over the erased slot (no bit changes)
+ */
+uint16_t state_store_bod_measure(void);
+
+/**
+ * @brief  Deferred commit and spare page erase
+ * @param  quiet: 1 = no reception in progress (DWIN frame, IR frame):
+ *         bytes or edges arriving during an erase would be lost
+ * @retval None
+ * @note   Main loop. Programs one 8-byte record (~0.2ms) when due; page
+ *         erases (~5ms stall) only run while quiet and no fade is in
+ *         progress. A used brown-out page is erased once its state is
+ *         in the log
+ */
+void state_store_task(uint8_t quiet);
+
+#endif
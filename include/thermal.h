@@ -0,0 +1,64 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+thermal.h
+
+Heatsink NTC thermal derating for MS51FB9AE
+10k B3950 NTC to GND, 10k pull-up to VDD, on AIN0 (P1.7)
+--------------------------------------------------------------------------*/
+#ifndef _THERMAL_H_
+#define _THERMAL_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Set to 0 on boards without the heatsink NTC */
+#ifndef THERMAL_ENABLE
+#define THERMAL_ENABLE          1
+#endif
+
+/* Derating band: full output below START, THERMAL_LIMIT_MIN at END and above */
+#ifndef THERMAL_DERATE_START_C
+#define THERMAL_DERATE_START_C  70
+#endif
+#ifndef THERMAL_DERATE_END_C
+#define THERMAL_DERATE_END_C    90
+#endif
+#ifndef THERMAL_LIMIT_MIN
+#define THERMAL_LIMIT_MIN       64      // Q8: 25% of requested intensity
+#endif
+
+#define THERMAL_LIMIT_FULL      256     // Q8: 100%
+
+/**
+ * @brief  Reset filter and limit (full output until the first reading)
+ * @retval None
+ * @note   Sampling is started by adc_sense_init()
+ */
+void thermal_init(void);
+
+/**
+ * @brief  Filter new NTC samples and run the derating controller
+ * @retval 1 = output limit changed, re-apply the duty
+ * @note   Main loop
+ */
+uint8_t thermal_task(void);
+
+/**
+ * @brief  Get current intensity limit
+ * @retval Q8 factor, THERMAL_LIMIT_MIN..THERMAL_LIMIT_FULL
+ */
+uint16_t thermal_limit(void);
+
+/**
+ * @brief  Get filtered heatsink temperature
+ * @retval Degrees C (0..130), 0xFF = sensor open or shorted
+ */
+uint8_t thermal_temp_c(void);
+
+#endif
@@ -0,0 +1,52 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+timebase.h
+
+System timebase on Timer2 for MS51FB9AE @ 24MHz
+Free-running 1.5MHz timestamp counter + 1ms tick via compare match
+--------------------------------------------------------------------------*/
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Timer2 = Fsys/16: 1 tick = 16 system clocks = 0.667us, wraps every 43.69ms */
+#define TIMEBASE_SYSCLK_SHIFT   4
+#define TIMEBASE_TICKS_PER_MS   1500
+
+/*
+ * Read the free-running counter from any context (ISR safe, no call).
+ * If TH2 moved while reading, TL2 has just wrapped: use TH2:00.
+ */
+#define TIMEBASE_READ(t)    do { uint8_t _th = TH2;                             \
+                                 (t) = ((uint16_t)_th << 8) | TL2;               \
+                                 if (TH2 != _th) (t) = (uint16_t)TH2 << 8;       \
+                            } while (0)
+
+/**
+ * @brief  Start Timer2 free-running with a 1ms compare interrupt
+ * @retval None
+ * @note   Timer2_Delayxxx() in Delay.c must not be used afterwards
+ */
+void timebase_init(void);
+
+/**
+ * @brief  Milliseconds since timebase_init (wraps after 65.5s)
+ * @retval Millisecond counter
+ */
+uint16_t timebase_ms(void);
+
+/**
+ * @brief  Raw 1.5MHz timestamp for interval measurement
+ * @retval Timer2 counter (16-bit, wrapping)
+ */
+uint16_t timebase_ticks(void);
+
+#endif
@@ -0,0 +1,100 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+uart1.h
+
+Interrupt-driven UART1 driver for an RS-485 transceiver on MS51FB9AE
+TXD_1 P1.6, RXD_1 P0.2, DE/RE P0.0, baud rate from Timer3
+--------------------------------------------------------------------------*/
+#ifndef _UART1_H_
+#define _UART1_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* What runs on UART1 (Timer3 becomes its baud generator) */
+#define UART1_MODE_NONE         0
+#define UART1_MODE_LINK         1       // Controller bus, bus_link.c
+#define UART1_MODE_MODBUS       2       // Modbus RTU slave, modbus.c
+#define UART1_MODE_DMX          3       // DMX512 receiver, dmx.c (own ISR)
+
+/* Opt-in: the pins and Timer3 stay untouched unless a board has the transceiver */
+#ifndef UART1_MODE
+#define UART1_MODE              UART1_MODE_NONE
+#endif
+
+/* Modes that use the ring-buffered driver below */
+#define UART1_DRIVER            (UART1_MODE == UART1_MODE_LINK || UART1_MODE == UART1_MODE_MODBUS)
+
+/* Transceiver driver enable, high = transmit (DE and /RE tied together) */
+#define UART1_DE_PIN            P00
+
+#define UART1_RX_SIZE           32      // Power of 2
+#define UART1_TX_SIZE           32      // Power of 2
+
+/* Timebase ticks the driver stays on after the last stop bit starts (>= 1 bit) */
+#define UART1_TURNAROUND_MS     2
+
+#define UART1_PARITY_NONE       0       // 8N1, mode 1
+#define UART1_PARITY_EVEN       1       // 8E1, mode 3 with TB8/RB8 as parity
+
+/**
+ * @brief  Start UART1 on Timer3, transceiver receiving
+ * @param  u32Baudrate: Baud rate
+ * @param  parity: UART1_PARITY_xxx
+ * @retval None
+ */
+void uart1_init(unsigned long u32Baudrate, uint8_t parity);
+
+/**
+ * @brief  Bytes waiting in the RX ring
+ * @retval Byte count
+ */
+uint8_t uart1_available(void);
+
+/**
+ * @brief  Take one byte from the RX ring
+ * @retval Received byte (0 if the ring is empty)
+ */
+uint8_t uart1_read(void);
+
+/**
+ * @brief  Time since the last received byte
+ * @retval Timebase ticks (ms), saturates at 255
+ * @note   A tick count of n means n-1 .. n ms of silence
+ */
+uint8_t uart1_rx_idle_ms(void);
+
+/**
+ * @brief  Parity error or RX ring overflow since the last call
+ * @retval 1 = bytes were corrupted or lost
+ */
+uint8_t uart1_rx_error(void);
+
+/**
+ * @brief  Queue a whole frame and take the bus
+ * @param  buf: Frame bytes
+ * @param  len: Frame length
+ * @retval 1 = queued, 0 = not enough room (nothing queued)
+ */
+uint8_t uart1_write(uint8_t xdata *buf, uint8_t len);
+
+/**
+ * @brief  Bus released: TX ring empty and the driver turned off
+ * @retval 1 = idle
+ */
+uint8_t uart1_tx_idle(void);
+
+/**
+ * @brief  Bus turnaround and RX idle timer
+ * @retval None
+ * @note   Timebase ISR context (1ms)
+ */
+void uart1_tick(void);
+
+#endif
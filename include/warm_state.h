@@ -0,0 +1,48 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+warm_state.h
+
+Warm-reset state preservation for MS51FB9AE
+Checksummed image in a no-init XRAM region that STARTUP.A51 does not clear
+--------------------------------------------------------------------------*/
+#ifndef _WARM_STATE_H_
+#define _WARM_STATE_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+#include "state_store.h"
+
+/* No-init XRAM: 0x2F0-0x2FF, must match XDATALEN in STARTUP.A51 and the
+   XRAM size (0x2F0) in the project, so the linker places nothing there */
+#define NOINIT_XDATA_START      0x2F0
+#define NOINIT_XDATA_SIZE       16
+
+/* Region map: warm image 0x2F0 (6 bytes), watchdog record 0x2F8 (4 bytes) */
+#define NOINIT_WARM_ADDR        (NOINIT_XDATA_START)
+#define NOINIT_WATCHDOG_ADDR    (NOINIT_XDATA_START + 8)
+
+/**
+ * @brief  Load the warm image, if this is a warm reset
+ * @param  out: State before the reset (untouched if none)
+ * @retval 1 = warm reset with a valid image, 0 = cold start
+ * @note   Call first thing in main(). A power-on reset (PCON.POF) always
+ *         counts as cold, so XRAM power-up garbage is never trusted
+ */
+uint8_t warm_state_load(State_t *out);
+
+/**
+ * @brief  Keep the warm image in step with the live state
+ * @param  st: Current state
+ * @retval None
+ * @note   Main loop, every pass; rewrites only on change. A reset during
+ *         the rewrite leaves a bad checksum, which is a cold start
+ */
+void warm_state_save(State_t *st);
+
+#endif
@@ -0,0 +1,109 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------
+watchdog.h
+
+Watchdog supervisor for MS51FB9AE
+Per-task check-ins gate the hardware WDT; a missed deadline warm-restarts
+--------------------------------------------------------------------------*/
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+#include "MS51_16K.h"
+#include "SFR_Macro.h"
+#include "Function_define.h"
+
+/* Needs CONFIG4 WDTEN = 0101: WDT reset enabled and running from reset
+   (1111 only leaves it a general purpose timer that never resets) */
+#ifndef WATCHDOG_ENABLE
+#define WATCHDOG_ENABLE         1
+#endif
+
+/* Main loop tasks, in loop order */
+#define WDT_TASK_IR             0
+#define WDT_TASK_DWIN           1       // Frames, boot sync, bus link, beeper
+#define WDT_TASK_STATE          2       // State cache, flash log, BOD arm
+#define WDT_TASK_SENSE          3       // Cam sync, thermal, current, fault
+#define WDT_TASK_COUNT          4
+#define WDT_TASK_NONE           0xFF
+
+/* Check-in deadlines, ms (longest legit pass: writeScr 100ms + erase 5ms) */
+#ifndef WDT_DEADLINE_IR_MS
+#define WDT_DEADLINE_IR_MS      300
+#endif
+#ifndef WDT_DEADLINE_DWIN_MS
+#define WDT_DEADLINE_DWIN_MS    300
+#endif
+#ifndef WDT_DEADLINE_STATE_MS
+#define WDT_DEADLINE_STATE_MS   300
+#endif
+#ifndef WDT_DEADLINE_SENSE_MS
+#define WDT_DEADLINE_SENSE_MS   300
+#endif
+
+/* Hardware WDT backstop (timebase ISR dead): WDPS = 7, 1.64s on LIRC */
+#define WDT_WDPS                0x07
+
+/* Reset causes (high byte of the ADDR_RESET_CAUSE VP) */
+#define RESET_POWER_ON          0
+#define RESET_BROWN_OUT         1
+#define RESET_PIN               2
+#define RESET_WATCHDOG          3       // Hardware WDT: timebase ISR stopped
+#define RESET_TASK_MISS         4       // Supervisor: task missed its deadline
+#define RESET_SOFTWARE          5
+
+/**
+ * @brief  Set the hardware WDT period, read and clear the reset flags,
+ *         load the no-init miss record
+ * @retval None
+ * @note   Call first thing after reset: the WDT already runs at the reset
+ *         period. Before MODIFY_HIRC_24576(), which clears PCON.POF
+ */
+void watchdog_init(void);
+
+/**
+ * @brief  Arm all task deadlines
+ * @retval None
+ * @note   Call right before the main loop; the timebase tick keeps the
+ *         hardware WDT cleared until then
+ */
+void watchdog_start(void);
+
+/**
+ * @brief  Task check-in, reloads its deadline
+ * @param  task: WDT_TASK_xxx
+ * @retval None
+ * @note   Main loop only
+ */
+void watchdog_checkin(uint8_t task);
+
+/**
+ * @brief  Count down the deadlines, kick or warm-restart
+ * @retval None
+ * @note   Timebase ISR context (1ms)
+ */
+void watchdog_tick(void);
+
+/**
+ * @brief  Cause of the last reset
+ * @retval RESET_xxx
+ */
+uint8_t watchdog_reset_cause(void);
+
+/**
+ * @brief  Task that missed its deadline before the last reset
+ * @retval WDT_TASK_xxx, WDT_TASK_NONE if the reset was not a task miss
+ */
+uint8_t watchdog_missed_task(void);
+
+/**
+ * @brief  Task misses since power-on (kept through warm resets)
+ * @retval Miss count
+ */
+uint8_t watchdog_miss_count(void);
+
+#endif
@@ -16,6 +16,9 @@
 /* Global bit variable for interrupt-safe SFR access */
 BIT BIT_TMP;
 
+/* Running system clock, Hz (updated by the HIRC trim in main.c) */
+unsigned long xdata u32SysClock = 24000000UL;
+
 /**
  * @brief  Initialize UART0 with Timer1 as baud rate generator
  * @param  u32Baudrate: Desired baud rate (e.g., 115200)
@@ -88,6 +91,8 @@ void InitialUART0_Timer3(unsigned long u32Baudrate)
  */
 void InitialUART1_Timer3(unsigned long u32Baudrate)
 {
+    unsigned int u16Reload;
+
     /* Configure P1.6 (TXD_1) and P0.2 (RXD_1) for UART1 */
     P16_PUSHPULL_MODE;
     P02_INPUT_MODE;
@@ -99,9 +104,11 @@ void InitialUART1_Timer3(unsigned long u32Baudrate)
     set_T3CON_BRCK;
     set_T3CON_SMOD_1;
     
-    /* Calculate Timer3 reload value */
-    RH3 = HIBYTE(65536 - (24000000UL / 16UL / u32Baudrate));
-    RL3 = LOBYTE(65536 - (24000000UL / 16UL / u32Baudrate));
+    /* Calculate Timer3 reload value from the running clock, rounded
+     * (the HIRC is only trimmed to 24.576MHz on a cold boot) */
+    u16Reload = 65536UL - ((u32SysClock / 8UL / u32Baudrate + 1) >> 1);
+    RH3 = HIBYTE(u16Reload);
+    RL3 = LOBYTE(u16Reload);
     
     /* Start Timer3 */
     set_T3CON_TR3;
@@ -0,0 +1,250 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     adc_sense.c
+ * @brief    Interrupt-driven ADC sampling scheduler for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     One ADC, several users: the 1ms timebase tick walks a fixed
+ *           slot sequence and starts or arms one conversion per tick; the
+ *           ADC interrupt accumulates it into that slot. Oversampled sums
+ *           are published to the main loop, which does filtering and
+ *           control. No busy-waiting on ADCF anywhere.
+ *
+ * Slot Sequence (both sensors fitted):
+ *   NTC, WHITE, NTC, YELLOW -> NTC every 2ms, each shunt every 4ms
+ *
+ * On-Phase Shunt Sampling:
+ *   - The ADC external trigger taps PWM0/PWM4, which mirror the White/
+ *     Yellow compare values (led_pwm.c)
+ *   - White turns on at period start: PWM0 rising edge
+ *   - Yellow turns on at period start (PWM4 rising), or at its compare
+ *     point when interleaved (PWM4 falling)
+ *   - ADCDLY moves the sample past the driver turn-on transient
+ *   - With FAULT_BRAKE_ENABLE the shunt slots also arm the ADC compare
+ *     with the channel trip level; an overcurrent sample brakes the PWM
+ *     in hardware (fault.c). NTC slots run with the compare off
+ *   - A slot whose trigger never came (0%/100% duty) is disarmed by the
+ *     next tick; pulses too short to sample are not armed at all
+ ******************************************************************************/
+
+#include "adc_sense.h"
+#include "led_pwm.h"
+#include "fault.h"
+
+/* ADCCON0: external trigger source select */
+#define ADCCON0_ETGSEL_PWM0     0x00
+#define ADCCON0_ETGSEL_PWM4     0x20
+
+/* ADCCON1: ADC clock Fsys/8 (3MHz), trigger edge, external trigger, ADCEN */
+#define ADCCON1_DIV8            0x30
+#define ADCCON1_ETGTYP_MASK     0x0C
+#define ADCCON1_ETGTYP_FALLING  0x00
+#define ADCCON1_ETGTYP_RISING   0x04
+#define ADCCON1_ADCEX           0x02
+
+/* ADCCON2: longest acquisition time for the high-impedance NTC divider */
+#define ADCCON2_AQT_MAX         0x0E
+/* ADCCON2: compare result (ADCR >= ADCMP) asserts the PWM fault brake */
+#define ADCCON2_FAULT_BRAKE     0xA0    /* ADFBEN | ADCMPEN */
+
+#if FAULT_BRAKE_ENABLE
+/* Trip level for the armed shunt slot; ADCMPH = bits 11..4, ADCMPL = 3..0 */
+#define ADC_FAULT_ARM(trip)     ADCMPH = (uint8_t)((trip) >> 4);                \
+                                ADCMPL = (uint8_t)((trip) & 0x0F);              \
+                                ADCCON2 = ADCCON2_AQT_MAX | ADCCON2_FAULT_BRAKE
+#define ADC_FAULT_DISARM()      ADCCON2 = ADCCON2_AQT_MAX
+#else
+#define ADC_FAULT_ARM(trip)
+#define ADC_FAULT_DISARM()
+#endif
+
+/* AINDIDS: digital input buffers off on analog pins */
+#define AINDIDS_NTC             0x01
+#define AINDIDS_ISENSE          0xC0
+
+/* On-time needed for delay + acquisition, in PWM clocks at Fsys/1 */
+#define ISENSE_MIN_ON_CLK       (ADC_ISENSE_MIN_ON_US * 24)
+
+#define SLOT_NTC                0
+#define SLOT_WHITE              1
+#define SLOT_YELLOW             2
+
+#if THERMAL_ENABLE && ADC_ISENSE_ENABLE
+static uint8_t code s_sequence[] = { SLOT_NTC, SLOT_WHITE, SLOT_NTC, SLOT_YELLOW };
+#elif ADC_ISENSE_ENABLE
+static uint8_t code s_sequence[] = { SLOT_WHITE, SLOT_YELLOW };
+#else
+static uint8_t code s_sequence[] = { SLOT_NTC };
+#endif
+#define SEQUENCE_LEN            (sizeof(s_sequence) / sizeof(s_sequence[0]))
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static bit s_enabled = 0;
+static bit s_armed = 0;                     /* Waiting on a PWM trigger */
+static uint8_t s_step = 0;
+static uint8_t s_slot = SLOT_NTC;
+
+/* Accumulators (ISR only) */
+static uint16_t xdata s_ntc_acc = 0;
+static uint8_t xdata s_ntc_count = 0;
+static uint16_t xdata s_is_acc[2];
+static uint8_t xdata s_is_count[2];
+
+/* Published results */
+static volatile uint16_t xdata s_ntc_sum = 0;
+static volatile bit s_ntc_new = 0;
+static volatile uint16_t xdata s_is_sum[2];
+static volatile uint8_t s_is_new = 0;       /* bit per channel */
+
+/*===========================================================================*/
+/* ADC Conversion Complete Interrupt (Vector 11)                              */
+/*===========================================================================*/
+void ADC_ISR(void) interrupt 11
+{
+    uint16_t result;
+    uint8_t ch;
+
+    clr_ADCCON0_ADCF;
+
+    /* One trigger per arming */
+    ADCCON1 &= ~ADCCON1_ADCEX;
+    s_armed = 0;
+
+    /* 12-bit result: ADCRH = bits 11..4, ADCRL[3:0] = bits 3..0 */
+    result = ((uint16_t)ADCRH << 4) | (ADCRL & 0x0F);
+
+    if (s_slot == SLOT_NTC)
+    {
+        s_ntc_acc += result;
+        if (++s_ntc_count >= (1 << ADC_NTC_OVERSAMPLE_SHIFT))
+        {
+            s_ntc_sum = s_ntc_acc;
+            s_ntc_new = 1;
+            s_ntc_acc = 0;
+            s_ntc_count = 0;
+        }
+        return;
+    }
+
+    ch = s_slot - SLOT_WHITE;
+    s_is_acc[ch] += result;
+    if (++s_is_count[ch] >= (1 << ADC_ISENSE_OVERSAMPLE_SHIFT))
+    {
+        s_is_sum[ch] = s_is_acc[ch];
+        s_is_new |= (1 << ch);
+        s_is_acc[ch] = 0;
+        s_is_count[ch] = 0;
+    }
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void adc_sense_init(void)
+{
+#if THERMAL_ENABLE
+    P17_Input_Mode;
+    AINDIDS |= AINDIDS_NTC;
+#endif
+#if ADC_ISENSE_ENABLE
+    P03_Input_Mode;
+    P11_Input_Mode;
+    AINDIDS |= AINDIDS_ISENSE;
+    ADCDLY = ADC_ISENSE_DELAY_CLK;
+#endif
+
+    ADCCON1 = ADCCON1_DIV8;
+    ADCCON2 = ADCCON2_AQT_MAX;
+    ADCCON0 = ADC_CH_NTC;           /* Clears ADCF/ADCS */
+    set_ADCCON1_ADCEN;
+
+    s_step = 0;
+    s_armed = 0;
+    s_ntc_acc = 0;
+    s_ntc_count = 0;
+    s_ntc_new = 0;
+    s_is_acc[0] = 0;
+    s_is_acc[1] = 0;
+    s_is_count[0] = 0;
+    s_is_count[1] = 0;
+    s_is_new = 0;
+
+    set_IE_EADC;
+    s_enabled = 1;
+}
+
+void adc_sense_tick(void)
+{
+    uint16_t min_on;
+
+    /* Not configured yet, or a conversion still running */
+    if (!s_enabled || ADCS) return;
+
+    /* Trigger edge never came: disarm and move on */
+    if (s_armed)
+    {
+        ADCCON1 &= ~ADCCON1_ADCEX;
+        s_armed = 0;
+    }
+
+    if (++s_step >= SEQUENCE_LEN) s_step = 0;
+    s_slot = s_sequence[s_step];
+
+    if (s_slot == SLOT_NTC)
+    {
+        ADC_FAULT_DISARM();
+        ADCCON0 = ADC_CH_NTC;
+        set_ADCCON0_ADCS;
+        return;
+    }
+
+    min_on = ISENSE_MIN_ON_CLK >> LED_PWM_CLOCK_SHIFT();
+
+    if (s_slot == SLOT_WHITE)
+    {
+        if (led_pwm_counts_white() < min_on) return;
+        ADC_FAULT_ARM(FAULT_TRIP_WHITE_ADC);
+        ADCCON0 = ADC_CH_ISENSE_WHITE | ADCCON0_ETGSEL_PWM0;
+        ADCCON1 = (ADCCON1 & ~ADCCON1_ETGTYP_MASK) | ADCCON1_ETGTYP_RISING | ADCCON1_ADCEX;
+    }
+    else
+    {
+        if (led_pwm_counts_yellow() < min_on) return;
+        ADC_FAULT_ARM(FAULT_TRIP_YELLOW_ADC);
+        ADCCON0 = ADC_CH_ISENSE_YELLOW | ADCCON0_ETGSEL_PWM4;
+        ADCCON1 = (ADCCON1 & ~ADCCON1_ETGTYP_MASK) | ADCCON1_ADCEX |
+                  (led_pwm_interleaved() ? ADCCON1_ETGTYP_FALLING : ADCCON1_ETGTYP_RISING);
+    }
+    s_armed = 1;
+}
+
+uint8_t adc_sense_ntc(uint16_t *sum)
+{
+    if (!s_ntc_new) return 0;
+
+    clr_IE_EADC;
+    *sum = s_ntc_sum;
+    s_ntc_new = 0;
+    set_IE_EADC;
+
+    return 1;
+}
+
+uint8_t adc_sense_isense(uint8_t ch, uint16_t *sum)
+{
+    if (!(s_is_new & (1 << ch))) return 0;
+
+    clr_IE_EADC;
+    *sum = s_is_sum[ch];
+    s_is_new &= ~(1 << ch);
+    set_IE_EADC;
+
+    return 1;
+}
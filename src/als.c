@@ -0,0 +1,157 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     als.c
+ * @brief    Daylight harvesting on an I2C ambient light sensor for MS51FB9AE
+ * @version  1.0.0
+ * @note     The sensor sees daylight plus our own light, so holding its
+ *           reading at ALS_TARGET_LUX closes the loop: White is dimmed
+ *           while daylight makes up the difference.
+ *
+ * Sensor (OPT3001): continuous 100ms conversions, automatic full scale
+ *   - Config 0x01 <- 0xC610 (written again after read failures)
+ *   - Result 0x00: lux = 0.01 x 2^E x M  (E = bits 15..12, M = 11..0)
+ *
+ * Controller (every ALS_PERIOD_MS):
+ *   - Inside +/- ALS_HYST_PCT of the target: hold (no hunting)
+ *   - Outside: one ALS_SLEW_Q12 step of the Q12 White gain per period,
+ *     ~2%/s, well below what the eye notices
+ *   - Gain range ALS_GAIN_MIN .. 4096: never brighter than the user setting
+ *   - ALS_FAIL_MAX failed reads in a row: the gain slews back to 4096
+ ******************************************************************************/
+
+#include "als.h"
+#include "timebase.h"
+
+#if I2C_MODE == I2C_MODE_ALS
+
+#define ALS_REG_RESULT      0x00
+#define ALS_REG_CONFIG      0x01
+#define ALS_CONFIG_H        0xC6    /* Auto range, 100ms, continuous */
+#define ALS_CONFIG_L        0x10    /* Latched window */
+
+#define ALS_GAIN_UNITY      4096
+#define ALS_HYST_LUX        ((uint16_t)((uint32_t)ALS_TARGET_LUX * ALS_HYST_PCT / 100))
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static I2C_Xfer_t xdata s_xfer;
+static bit s_configured = 0;
+static uint8_t xdata s_fails = 0;
+static uint16_t xdata s_ms = 0;
+static uint16_t xdata s_gain = ALS_GAIN_UNITY;
+static uint16_t xdata s_lux = 0;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* Step the gain towards the target; 1 = changed */
+static uint8_t regulate(void)
+{
+    uint16_t gain;
+
+    gain = s_gain;
+
+    if (s_fails >= ALS_FAIL_MAX || s_lux < ALS_TARGET_LUX - ALS_HYST_LUX)
+    {
+        /* Too dark (or blind): give White back */
+        gain = (gain > ALS_GAIN_UNITY - ALS_SLEW_Q12) ? ALS_GAIN_UNITY : gain + ALS_SLEW_Q12;
+    }
+    else if (s_lux > ALS_TARGET_LUX + ALS_HYST_LUX)
+    {
+        gain = (gain < ALS_GAIN_MIN + ALS_SLEW_Q12) ? ALS_GAIN_MIN : gain - ALS_SLEW_Q12;
+    }
+
+    if (gain == s_gain) return 0;
+
+    s_gain = gain;
+    return 1;
+}
+
+static void read_done(void)
+{
+    uint32_t centilux;
+
+    centilux = (uint32_t)(((uint16_t)(s_xfer.buf[0] & 0x0F) << 8) | s_xfer.buf[1]) << (s_xfer.buf[0] >> 4);
+    centilux /= 100;
+    s_lux = (centilux > 0xFFFF) ? 0xFFFF : (uint16_t)centilux;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void als_init(void)
+{
+    i2c_init();
+    s_xfer.status = I2C_IDLE;
+    s_ms = timebase_ms();
+}
+
+uint8_t als_task(void)
+{
+    uint8_t status;
+
+    status = s_xfer.status;
+    if (status == I2C_PENDING) return 0;
+
+    if (status != I2C_IDLE)
+    {
+        s_xfer.status = I2C_IDLE;
+
+        if (status == I2C_ERROR)
+        {
+            if (s_fails < ALS_FAIL_MAX) s_fails++;
+            if (s_fails >= ALS_FAIL_MAX) s_configured = 0;
+        }
+        else if (s_xfer.rd_len)
+        {
+            s_fails = 0;
+            read_done();
+        }
+
+        /* Config writes only arm the next read */
+        if (s_xfer.rd_len || status == I2C_ERROR) return regulate();
+    }
+
+    if ((uint16_t)(timebase_ms() - s_ms) < ALS_PERIOD_MS) return 0;
+    s_ms = timebase_ms();
+
+    if (!s_configured)
+    {
+        s_xfer.addr = ALS_ADDR;
+        s_xfer.buf[0] = ALS_REG_CONFIG;
+        s_xfer.buf[1] = ALS_CONFIG_H;
+        s_xfer.buf[2] = ALS_CONFIG_L;
+        s_xfer.wr_len = 3;
+        s_xfer.rd_len = 0;
+        s_configured = 1;
+    }
+    else
+    {
+        s_xfer.addr = ALS_ADDR;
+        s_xfer.buf[0] = ALS_REG_RESULT;
+        s_xfer.wr_len = 1;
+        s_xfer.rd_len = 2;
+    }
+    i2c_submit(&s_xfer);
+
+    return 0;
+}
+
+uint16_t als_gain(void)
+{
+    return s_gain;
+}
+
+uint16_t als_lux(void)
+{
+    return s_lux;
+}
+
+#endif
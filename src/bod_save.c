@@ -0,0 +1,113 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     bod_save.c
+ * @brief    Brown-out triggered last-state save for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     The state log commits only after the state has been stable for
+ *           STATE_COMMIT_DELAY_MS, so a power cut right after a change
+ *           would lose it. The BOD interrupt closes that window.
+ *
+ * Save Path (BOD ISR, highest priority):
+ *   - LED outputs off first: the bulk capacitors then only feed the MCU
+ *   - state_store_bod_commit(): 8 byte programs of a prebuilt record into
+ *     a slot that was erased in advance (no erase, no checksum work)
+ *   - Wait for the supply to either recover (BOS clear -> software reset,
+ *     clean boot) or collapse (POR)
+ *
+ * Budget:
+ *   - bod_save_init() times the same 8 programs over the blank slot
+ *     (0xFF, no bits change) and reports the cost for comparison with
+ *     BOD_HOLDUP_US measured on the board
+ ******************************************************************************/
+
+#include "bod_save.h"
+#include "state_store.h"
+
+/* BODCON0 bits */
+#define BODCON0_BODEN       0x80
+#define BODCON0_BOF         0x08
+#define BODCON0_BORST       0x04
+#define BODCON0_BOS         0x01
+
+/* Enabled at BOD_LEVEL, interrupt instead of reset, BOF cleared */
+#define BODCON0_INT_MODE    (BODCON0_BODEN | BOD_LEVEL)
+
+/* IPH.5: BOD high priority bit (with IP.PBOD -> level 3) */
+#define IPH_PBODH           0x20
+
+#define BODCON0_WRITE(v)    TA = 0xAA; TA = 0x55; BODCON0 = (v)
+#define SFRPAGE_0_ISR()     TA = 0xAA; TA = 0x55; SFRS = 0
+#define SFRPAGE_1_ISR()     TA = 0xAA; TA = 0x55; SFRS = 1
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static bit s_armed = 0;
+
+/*===========================================================================*/
+/* Brown-out Interrupt (Vector 8)                                             */
+/*===========================================================================*/
+void BOD_ISR(void) interrupt 8
+{
+    /* LEDs off: PWM pins to GPIO, latched low */
+    SFRPAGE_0_ISR();
+    PWM1_P14_OUTPUT_DISABLE;
+    SFRPAGE_1_ISR();
+    PWM5_P15_OUTPUT_DISABLE;
+    SFRPAGE_0_ISR();
+    P14 = 0;
+    P15 = 0;
+    P04 = 0;
+
+    state_store_bod_commit();
+
+    /* Ride it out: recovery restarts cleanly, collapse ends in POR */
+    do
+    {
+        BODCON0_WRITE(BODCON0_INT_MODE);
+    } while (BODCON0 & BODCON0_BOS);
+
+    TA = 0xAA; TA = 0x55; CHPCON |= 0x80;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+uint16_t bod_save_init(void)
+{
+    uint16_t ticks;
+
+    BODCON0_WRITE(BODCON0_INT_MODE);
+    PBOD = 1;
+    IPH |= IPH_PBODH;
+    s_armed = 0;
+
+    ticks = state_store_bod_measure();
+
+    bod_save_task();
+
+    /* Timebase ticks are 2/3 us */
+    return (uint16_t)(((uint32_t)ticks * 2 + 2) / 3);
+}
+
+uint8_t bod_save_task(void)
+{
+    if (s_armed) return 0;
+    if (BODCON0 & BODCON0_BOS) return 0;
+
+    BODCON0_WRITE(BODCON0_INT_MODE);
+    s_armed = 1;
+    set_IE_EBOD;
+    return 1;
+}
+
+uint8_t bod_save_armed(void)
+{
+    return s_armed;
+}
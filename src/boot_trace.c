@@ -0,0 +1,77 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     boot_trace.c
+ * @brief    Boot time trace for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Timer2 starts from 0 in timebase_init(), the first thing main()
+ *           does after GPIO_Init(), so its counter is time since boot
+ *           minus the startup code before it (memory clear, GPIO_Init),
+ *           which is not measured.
+ *
+ * Marks:
+ *   - Light: first fade tick that drives a non-zero duty (1.5MHz stamp),
+ *     only before the counter wraps; a later first light is not timed
+ *   - Synced: boot VP writes queued and the UART TX ring drained (ms)
+ ******************************************************************************/
+
+#include "boot_trace.h"
+#include "timebase.h"
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static volatile bit s_lit = 0;
+static volatile bit s_closed = 0;
+static volatile uint16_t xdata s_light_ticks = 0;
+static uint16_t xdata s_sync_ms = BOOT_TRACE_NONE;
+
+/*===========================================================================*/
+/* Light Mark - timebase ISR context                                          */
+/*===========================================================================*/
+void boot_trace_light(void)
+{
+    if (s_lit || s_closed) return;
+
+    TIMEBASE_READ(s_light_ticks);
+    s_lit = 1;
+}
+
+void boot_trace_close(void)
+{
+    s_closed = 1;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void boot_trace_synced(void)
+{
+    if (s_sync_ms != BOOT_TRACE_NONE) return;
+
+    s_sync_ms = timebase_ms();
+}
+
+uint16_t boot_trace_light_us(void)
+{
+    uint16_t ticks;
+
+    if (!s_lit) return BOOT_TRACE_NONE;
+
+    clr_EIE_ET2;
+    ticks = s_light_ticks;
+    set_EIE_ET2;
+
+    /* 1 tick = 2/3 us */
+    return (uint16_t)(((uint32_t)ticks * 2 + 1) / 3);
+}
+
+uint16_t boot_trace_sync_ms(void)
+{
+    return s_sync_ms;
+}
@@ -0,0 +1,262 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     bus_link.c
+ * @brief    Multi-drop controller bus on UART1 (RS-485) for MS51FB9AE
+ * @version  1.0.0
+ * @note     Several controllers (and their wall displays) on one line act
+ *           as one light setting. The master owns the state; slaves only
+ *           talk in their own reply slot, so the half-duplex bus needs no
+ *           arbitration.
+ *
+ * Frame:
+ *   [A5][dst][src][cmd][len][payload: len bytes][check = ~sum(dst..payload)]
+ *
+ * Traffic:
+ *   - Master: STATE (power, brightness, cct, profile) to all on every
+ *     change, refreshed every BUS_REFRESH_MS for late joiners
+ *   - Slave n: a local change is sent as SET to the master in its slot,
+ *     n x BUS_SLOT_MS after a master frame. The master adopts it and
+ *     rebroadcasts it, which also confirms it to the slave
+ *   - Slave without a master for BUS_MASTER_TIMEOUT_MS: standalone, and
+ *     the master state wins once it is heard again
+ ******************************************************************************/
+
+#include "bus_link.h"
+#include "uart1.h"
+#include "timebase.h"
+
+#if UART1_MODE == UART1_MODE_LINK
+
+#define BUS_SYNC            0xA5
+#define BUS_CMD_STATE       0x01    /* Master -> all: current state */
+#define BUS_CMD_SET         0x02    /* Slave -> master: local change */
+
+#define BUS_HDR_LEN         5
+#define BUS_PAYLOAD_MAX     sizeof(State_t)
+#define BUS_FRAME_MAX       (BUS_HDR_LEN + BUS_PAYLOAD_MAX + 1)
+#define BUS_FRAME_TIMEOUT_MS 20     /* Gap that aborts a partial frame */
+
+/* Master: quiet time after a frame so that every slave slot fits */
+#define BUS_WINDOW_MS       ((BUS_NODE_MAX + 2) * BUS_SLOT_MS)
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static uint8_t xdata s_rx[BUS_FRAME_MAX];
+static uint8_t xdata s_rx_idx = 0;
+static uint16_t xdata s_rx_ms = 0;
+static uint8_t xdata s_tx[BUS_FRAME_MAX];
+
+static State_t xdata s_known;           /* Last state exchanged on the bus */
+static uint16_t xdata s_tx_ms = 0;
+#if BUS_NODE_ADDR != BUS_ADDR_MASTER
+static bit s_heard = 0;                 /* Master present */
+static bit s_slot_open = 0;
+static uint16_t xdata s_heard_ms = 0;
+#endif
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+static uint8_t state_equal(State_t *a, State_t *b)
+{
+    return a->power == b->power && a->brightness == b->brightness &&
+           a->cct == b->cct && a->profile == b->profile;
+}
+
+static void send_state(uint8_t dst, uint8_t cmd, State_t *st)
+{
+    uint8_t sum;
+
+    s_tx[0] = BUS_SYNC;
+    s_tx[1] = dst;
+    s_tx[2] = BUS_NODE_ADDR;
+    s_tx[3] = cmd;
+    s_tx[4] = sizeof(State_t);
+    s_tx[5] = st->power;
+    s_tx[6] = st->brightness;
+    s_tx[7] = st->cct;
+    s_tx[8] = st->profile;
+
+    sum = dst + BUS_NODE_ADDR + cmd + sizeof(State_t) +
+          st->power + st->brightness + st->cct + st->profile;
+    s_tx[9] = ~sum;
+
+    if (uart1_write(s_tx, BUS_FRAME_MAX)) s_tx_ms = timebase_ms();
+}
+
+/* Assemble frames from the RX ring; 1 = s_rx holds a valid frame for us */
+static uint8_t receive_frame(void)
+{
+    uint8_t d, i, sum;
+
+    while (uart1_available())
+    {
+        d = uart1_read();
+
+        if (s_rx_idx == 0 && d != BUS_SYNC) continue;
+
+        s_rx[s_rx_idx++] = d;
+        s_rx_ms = timebase_ms();
+
+        if (s_rx_idx == BUS_HDR_LEN && s_rx[4] > BUS_PAYLOAD_MAX)
+        {
+            s_rx_idx = 0;
+            continue;
+        }
+        if (s_rx_idx <= BUS_HDR_LEN || s_rx_idx < BUS_HDR_LEN + s_rx[4] + 1) continue;
+
+        s_rx_idx = 0;
+
+        sum = 0;
+        for (i = 1; i < BUS_HDR_LEN + s_rx[4]; i++) sum += s_rx[i];
+        if ((uint8_t)~sum != s_rx[BUS_HDR_LEN + s_rx[4]]) continue;
+
+        if (s_rx[2] == BUS_NODE_ADDR) continue;
+        if (s_rx[1] != BUS_NODE_ADDR && s_rx[1] != BUS_ADDR_BROADCAST) continue;
+        if (s_rx[4] != sizeof(State_t)) continue;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+static void frame_state(State_t *st)
+{
+    st->power = s_rx[5];
+    st->brightness = s_rx[6];
+    st->cct = s_rx[7];
+    st->profile = s_rx[8];
+}
+
+#if BUS_NODE_ADDR == BUS_ADDR_MASTER
+/*===========================================================================*/
+/* Master                                                                     */
+/*===========================================================================*/
+static uint8_t master_task(State_t *st, uint16_t now)
+{
+    State_t rx;
+    uint8_t changed = 0;
+
+    if (receive_frame() && s_rx[3] == BUS_CMD_SET)
+    {
+        /* Slave input: take it over, the broadcast below confirms it */
+        frame_state(&rx);
+        if (!state_equal(&rx, st))
+        {
+            *st = rx;
+            changed = 1;
+        }
+    }
+
+    if (!uart1_tx_idle()) return changed;
+    if ((uint16_t)(now - s_tx_ms) < BUS_WINDOW_MS) return changed;
+    if (state_equal(st, &s_known) && (uint16_t)(now - s_tx_ms) < BUS_REFRESH_MS) return changed;
+
+    s_known = *st;
+    send_state(BUS_ADDR_BROADCAST, BUS_CMD_STATE, st);
+
+    return changed;
+}
+#else
+/*===========================================================================*/
+/* Slave                                                                      */
+/*===========================================================================*/
+static uint8_t slave_task(State_t *st, uint16_t now)
+{
+    State_t rx;
+    uint16_t elapsed;
+    uint8_t changed = 0;
+
+    if (receive_frame() && s_rx[2] == BUS_ADDR_MASTER && s_rx[3] == BUS_CMD_STATE)
+    {
+        s_heard = 1;
+        s_heard_ms = now;
+        s_slot_open = 1;
+
+        /* An unconfirmed local change is kept and goes out in our slot,
+           unless the master moved meanwhile: then the master wins */
+        frame_state(&rx);
+        if (!state_equal(&rx, &s_known) || state_equal(st, &s_known))
+        {
+            s_known = rx;
+            if (!state_equal(st, &s_known))
+            {
+                *st = rx;
+                changed = 1;
+            }
+        }
+    }
+
+    if (!s_heard)
+    {
+        /* Standalone: nothing to forward, the master wins when it is back */
+        s_known = *st;
+        return changed;
+    }
+
+    if ((uint16_t)(now - s_heard_ms) > BUS_MASTER_TIMEOUT_MS)
+    {
+        s_heard = 0;
+        return changed;
+    }
+
+    if (s_slot_open)
+    {
+        elapsed = now - s_heard_ms;
+        if (elapsed >= (uint16_t)(BUS_NODE_ADDR + 1) * BUS_SLOT_MS)
+        {
+            /* Slot missed (long main loop pass): wait for the next frame */
+            s_slot_open = 0;
+        }
+        else if (elapsed >= (uint16_t)BUS_NODE_ADDR * BUS_SLOT_MS)
+        {
+            s_slot_open = 0;
+            if (!state_equal(st, &s_known) && uart1_tx_idle())
+            {
+                send_state(BUS_ADDR_MASTER, BUS_CMD_SET, st);
+            }
+        }
+    }
+
+    return changed;
+}
+#endif
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void bus_link_init(void)
+{
+    uart1_init(BUS_BAUD, UART1_PARITY_NONE);
+    s_rx_idx = 0;
+    s_known.power = 0xFF;       /* Nothing exchanged yet */
+    s_tx_ms = timebase_ms() - BUS_REFRESH_MS;
+}
+
+uint8_t bus_link_task(State_t *st)
+{
+    uint16_t now;
+
+    now = timebase_ms();
+
+    if (s_rx_idx && (uint16_t)(now - s_rx_ms) > BUS_FRAME_TIMEOUT_MS)
+    {
+        s_rx_idx = 0;
+    }
+
+#if BUS_NODE_ADDR == BUS_ADDR_MASTER
+    return master_task(st, now);
+#else
+    return slave_task(st, now);
+#endif
+}
+
+#endif
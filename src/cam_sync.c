@@ -0,0 +1,213 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     cam_sync.c
+ * @brief    Camera frame-sync PWM phase lock for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Rolling bands appear when the PWM period does not divide the
+ *           camera frame period. This module makes K PWM periods fit one
+ *           frame exactly and aligns a PWM period boundary to the frame
+ *           pulse.
+ *
+ * Software PLL (per frame, main loop):
+ *   - Frequency: frame period (timebase ticks) / K, K = nearest integer
+ *     to frame / nominal period -> period target, IIR filtered (drift)
+ *   - Phase: frame pulse time minus last PWM boundary stamp, wrapped to
+ *     +/- half a period; half the error is removed per frame by spreading
+ *     it over the K periods
+ *   - Period trim is at most 1/(2K) of nominal, so duty-to-light scaling
+ *     is unaffected (< 0.6% at 2.7kHz/30fps)
+ *   - No pulse for CAM_SYNC_TIMEOUT_MS -> nominal period (free running)
+ *   - The phase needs the PWM period ISR; on the 43K profile it is not
+ *     run (43k interrupts/s, ~25% CPU) and the PWM stays free running.
+ *     43kHz already puts hundreds of periods in a line exposure
+ ******************************************************************************/
+
+#include "cam_sync.h"
+#include "led_pwm.h"
+#include "timebase.h"
+
+/* Max trim: 1/16 of the nominal period */
+#define CAM_SYNC_TRIM_SHIFT     4
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static bit s_armed = 0;
+static CAM_Sync_State_t xdata s_state = CAM_SYNC_OFF;
+
+/* Edge capture (pin ISR -> main loop) */
+static volatile bit s_edge_new = 0;
+static volatile bit s_edge_primed = 0;     /* s_edge_last holds a real edge */
+static volatile uint16_t xdata s_edge_dt = 0;
+static volatile uint16_t xdata s_edge_phase = 0;
+static uint16_t xdata s_edge_last = 0;
+
+/* Loop state */
+static uint16_t xdata s_nominal = 0;      /* Profile nominal, PWM clocks */
+static uint16_t xdata s_period_q4 = 0;    /* Filtered period, PWM clocks Q4 */
+static uint16_t xdata s_last_ms = 0;
+static uint8_t xdata s_good_frames = 0;
+
+/*===========================================================================*/
+/* Frame edge - pin interrupt context                                         */
+/*===========================================================================*/
+void cam_sync_edge(void)
+{
+    uint16_t now;
+
+    TIMEBASE_READ(now);
+    if (!s_armed) return;
+
+    /* First edge after arming or a timeout: only a time reference */
+    if (!s_edge_primed)
+    {
+        s_edge_last = now;
+        s_edge_primed = 1;
+        return;
+    }
+
+    s_edge_dt = now - s_edge_last;
+    s_edge_phase = now - led_pwm_period_stamp();
+    s_edge_last = now;
+    s_edge_new = 1;
+}
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+static void sync_free_run(void)
+{
+    led_pwm_trim_period(0);
+    s_edge_primed = 0;
+    s_period_q4 = 0;
+    s_good_frames = 0;
+    s_state = s_armed ? CAM_SYNC_FREE : CAM_SYNC_OFF;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void cam_sync_init(void)
+{
+    P01_Input_Mode;
+    ENABLE_PIT1_P01_RISINGEDGE;
+    s_armed = 0;
+    s_state = CAM_SYNC_OFF;
+}
+
+void cam_sync_arm(uint8_t enable)
+{
+    clr_EPI;
+    s_armed = enable ? 1 : 0;
+    s_edge_new = 0;
+    s_edge_primed = 0;
+    set_EPI;
+    led_pwm_stamp(s_armed);
+    sync_free_run();
+}
+
+void cam_sync_task(void)
+{
+    uint16_t dt, phase;
+    uint16_t k, period_clk, trim_max;
+    uint32_t frame_clk;
+    int16_t err, corr;
+    uint8_t shift;
+
+    if (!s_armed) return;
+
+    if (!s_edge_new)
+    {
+        if (s_state != CAM_SYNC_FREE &&
+            (uint16_t)(timebase_ms() - s_last_ms) > CAM_SYNC_TIMEOUT_MS)
+        {
+            sync_free_run();
+        }
+        return;
+    }
+
+    clr_EPI;
+    dt = s_edge_dt;
+    phase = s_edge_phase;
+    s_edge_new = 0;
+    set_EPI;
+
+    s_last_ms = timebase_ms();
+
+    /* No phase reference on the 43K profile (no period ISR): free running */
+    if (!led_pwm_stamping())
+    {
+        if (s_state != CAM_SYNC_FREE) sync_free_run();
+        return;
+    }
+
+    /* Missed pulses or glitches: measure again next frame */
+    if (dt < CAM_SYNC_FRAME_MIN || dt > CAM_SYNC_FRAME_MAX)
+    {
+        s_good_frames = 0;
+        return;
+    }
+
+    /* Restart the loop when the PWM profile changed */
+    if (s_nominal != led_pwm_period() + 1)
+    {
+        s_nominal = led_pwm_period() + 1;
+        s_period_q4 = 0;
+    }
+
+    /* Timebase ticks -> PWM clocks */
+    shift = TIMEBASE_SYSCLK_SHIFT - led_pwm_clock_shift();
+    frame_clk = (uint32_t)dt << shift;
+
+    /* Frequency: K whole periods per frame */
+    k = (uint16_t)((frame_clk + (s_nominal >> 1)) / s_nominal);
+    if (k == 0) k = 1;
+    if (s_period_q4 == 0)
+    {
+        s_period_q4 = (uint16_t)((frame_clk << 4) / k);
+    }
+    else
+    {
+        s_period_q4 += (int16_t)((uint16_t)((frame_clk << 4) / k) - s_period_q4) >> 2;
+    }
+    period_clk = s_period_q4 >> 4;
+
+    /* Phase: time since the last PWM boundary, wrapped to +/- P/2 */
+    phase = (uint16_t)(((uint32_t)phase << shift) % period_clk);
+    err = (phase > (period_clk >> 1)) ? (int16_t)(phase - period_clk) : (int16_t)phase;
+
+    /* Boundary came early (err > 0): lengthen; remove err/2 over K periods */
+    corr = (int16_t)(((int32_t)err << 3) / (int16_t)k);
+
+    trim_max = s_nominal >> CAM_SYNC_TRIM_SHIFT;
+    if (corr > (int16_t)(trim_max << 4)) corr = (int16_t)(trim_max << 4);
+    if (corr < -(int16_t)(trim_max << 4)) corr = -(int16_t)(trim_max << 4);
+
+    period_clk = (uint16_t)((s_period_q4 + corr + 8) >> 4);
+    if (period_clk > s_nominal + trim_max) period_clk = s_nominal + trim_max;
+    if (period_clk < s_nominal - trim_max) period_clk = s_nominal - trim_max;
+
+    led_pwm_trim_period(period_clk - 1);
+
+    /* Lock detection */
+    if (err <= CAM_SYNC_LOCK_TOL && err >= -CAM_SYNC_LOCK_TOL)
+    {
+        if (s_good_frames < CAM_SYNC_LOCK_FRAMES) s_good_frames++;
+    }
+    else
+    {
+        s_good_frames = 0;
+    }
+    s_state = (s_good_frames >= CAM_SYNC_LOCK_FRAMES) ? CAM_SYNC_LOCKED : CAM_SYNC_TRACKING;
+}
+
+CAM_Sync_State_t cam_sync_state(void)
+{
+    return s_state;
+}
@@ -0,0 +1,119 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     current_loop.c
+ * @brief    Closed-loop LED current regulation for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Light per brightness step ~ on-current x duty. The on-current
+ *           drifts with LED temperature and supply, so the duty is scaled
+ *           by a per-channel gain that holds on-current x gain at the
+ *           calibrated reference.
+ *
+ * Loop (per channel, every 32ms when the channel is lit):
+ *   - Measurement: 8 on-phase shunt samples (Q3 of the 12-bit ADC)
+ *   - Delivered = measurement x gain; error relative to the reference, Q12
+ *   - PI: gain = 1 + integ + e/4, integ += e/8; both clamped to
+ *     CURRENT_TRIM_MAX (anti-windup)
+ *   - No samples (channel off or pulse too short): loop holds its gain
+ *   - The gain is applied in update_PWM(), so corrections ramp through
+ *     the fade engine; the loop is kept slow (~1s) against that lag
+ ******************************************************************************/
+
+#include "current_loop.h"
+
+#define PI_KP_SHIFT         2
+#define PI_KI_SHIFT         3
+
+/* Re-apply the duty only for gain moves of at least 1/512 */
+#define GAIN_DEADBAND       8
+
+#define LOOP_CHANNELS       2
+
+static uint16_t code s_ref_q3[LOOP_CHANNELS] = {
+    CURRENT_REF_WHITE_ADC << ADC_ISENSE_OVERSAMPLE_SHIFT,
+    CURRENT_REF_YELLOW_ADC << ADC_ISENSE_OVERSAMPLE_SHIFT
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static int16_t xdata s_integ[LOOP_CHANNELS];      /* Q12 */
+static uint16_t xdata s_gain[LOOP_CHANNELS];      /* Q12, in use by update_PWM */
+static uint16_t xdata s_gain_applied[LOOP_CHANNELS];
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+static int16_t clamp_trim(int16_t v)
+{
+    if (v > CURRENT_TRIM_MAX) return CURRENT_TRIM_MAX;
+    if (v < -CURRENT_TRIM_MAX) return -CURRENT_TRIM_MAX;
+    return v;
+}
+
+/* One PI step; meas = oversampled shunt sum */
+static void loop_update(uint8_t ch, uint16_t meas)
+{
+    uint16_t delivered;
+    int32_t err;
+    int16_t e_q12;
+
+    delivered = (uint16_t)(((uint32_t)meas * s_gain[ch]) >> 12);
+    err = (int32_t)s_ref_q3[ch] - delivered;
+    e_q12 = clamp_trim((int16_t)((err << 12) / (int32_t)s_ref_q3[ch]));
+
+    s_integ[ch] = clamp_trim(s_integ[ch] + (e_q12 >> PI_KI_SHIFT));
+    s_gain[ch] = CURRENT_GAIN_ONE + clamp_trim(s_integ[ch] + (e_q12 >> PI_KP_SHIFT));
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void current_loop_init(void)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < LOOP_CHANNELS; ch++)
+    {
+        s_integ[ch] = 0;
+        s_gain[ch] = CURRENT_GAIN_ONE;
+        s_gain_applied[ch] = CURRENT_GAIN_ONE;
+    }
+}
+
+uint8_t current_loop_task(void)
+{
+    uint16_t sum;
+    uint8_t ch;
+    uint8_t changed = 0;
+
+    for (ch = 0; ch < LOOP_CHANNELS; ch++)
+    {
+        if (!adc_sense_isense(ch, &sum)) continue;
+
+        loop_update(ch, sum);
+
+        if (s_gain[ch] > s_gain_applied[ch] + GAIN_DEADBAND ||
+            s_gain[ch] + GAIN_DEADBAND < s_gain_applied[ch])
+        {
+            changed = 1;
+        }
+    }
+
+    if (changed)
+    {
+        s_gain_applied[0] = s_gain[0];
+        s_gain_applied[1] = s_gain[1];
+    }
+    return changed;
+}
+
+uint16_t current_loop_gain(uint8_t ch)
+{
+    return s_gain_applied[ch];
+}
@@ -0,0 +1,143 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     dmx.c
+ * @brief    DMX512 receiver on UART1 (RS-485) for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Replaces uart1.c when UART1_MODE is UART1_MODE_DMX.
+ *
+ * Line: 250 kbaud, start + 8 data + 2 stop. UART1 runs in mode 3, so the
+ * first stop bit lands in RB8 and the UART checks the second one. With
+ * SMOD0_1 set, SCON_1.7 reads as FE_1.
+ *
+ * Packet: BREAK (>= 88us low) + MAB, start code, slots 1..512
+ *   - BREAK arrives as a 0x00 character with a framing error: slot = 0
+ *   - Start code 0x00 (dimmer data) opens the packet, others skip it
+ *   - Only slots DMX_START_ADDR .. +DMX_CHANNELS-1 are stored, the rest
+ *     of the universe is counted and dropped
+ *   - After the last wanted slot the values are latched for the main loop
+ *     and the ISR idles until the next BREAK
+ *
+ * A slot arrives every 44us, so the ISR runs one level above the others.
+ * Bytes lost while the CPU is halted by a flash erase only cost the packet
+ * they belong to.
+ ******************************************************************************/
+
+#include "dmx.h"
+#include "Common.h"
+#include "timebase.h"
+
+#if UART1_MODE == UART1_MODE_DMX
+
+#define DMX_SLOT_IDLE       0xFFFF  /* Waiting for BREAK */
+#define DMX_SLOT_LAST       (DMX_START_ADDR + DMX_CHANNELS - 1)
+
+/* EIP1.0: UART1 priority level 1, above the timebase and PWM interrupts */
+#define EIP1_PS_1           0x01
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static volatile uint16_t s_slot = DMX_SLOT_IDLE;   /* Slot the next byte is */
+static uint8_t xdata s_capture[DMX_CHANNELS];
+static volatile uint8_t xdata s_latch[DMX_CHANNELS];
+static volatile bit s_new = 0;
+
+static bit s_live = 0;
+static uint16_t xdata s_frame_ms = 0;
+
+/*===========================================================================*/
+/* UART1 Interrupt (Vector 15)                                                */
+/*===========================================================================*/
+void DMX_ISR(void) interrupt 15
+{
+    uint8_t d, i;
+
+    if (!RI_1) return;
+
+    d = SBUF_1;
+    RI_1 = 0;
+
+    if (FE_1)
+    {
+        /* BREAK: the start code comes next */
+        FE_1 = 0;
+        s_slot = 0;
+        return;
+    }
+
+    if (s_slot == DMX_SLOT_IDLE) return;
+
+    if (s_slot == 0)
+    {
+        s_slot = (d == 0x00) ? 1 : DMX_SLOT_IDLE;
+        return;
+    }
+
+    if (s_slot >= DMX_START_ADDR)
+    {
+        s_capture[s_slot - DMX_START_ADDR] = d;
+
+        if (s_slot == DMX_SLOT_LAST)
+        {
+            for (i = 0; i < DMX_CHANNELS; i++) s_latch[i] = s_capture[i];
+            s_new = 1;
+            s_slot = DMX_SLOT_IDLE;
+            return;
+        }
+    }
+
+    s_slot++;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void dmx_init(void)
+{
+    UART1_DE_PIN = 0;
+    P00_PUSHPULL_MODE;
+
+    InitialUART1_Timer3(DMX_BAUD);
+    SM0_1 = 1;                  /* Mode 3: 9-bit, Timer3 baud rate */
+    set_T3CON_SMOD0_1;          /* SCON_1.7 = FE_1 from here on */
+    FE_1 = 0;
+    RI_1 = 0;
+
+    s_slot = DMX_SLOT_IDLE;
+    s_frame_ms = timebase_ms();
+    EIP1 |= EIP1_PS_1;
+    set_EIE1_ES_1;
+}
+
+uint8_t dmx_task(uint8_t *levels)
+{
+    uint8_t i;
+
+    if (s_new)
+    {
+        clr_EIE1_ES_1;
+        for (i = 0; i < DMX_CHANNELS; i++) levels[i] = s_latch[i];
+        s_new = 0;
+        set_EIE1_ES_1;
+
+        s_live = 1;
+        s_frame_ms = timebase_ms();
+        return DMX_FRAME;
+    }
+
+    if (s_live && (uint16_t)(timebase_ms() - s_frame_ms) > DMX_TIMEOUT_MS)
+    {
+        s_live = 0;
+        return DMX_LOST;
+    }
+
+    return DMX_NONE;
+}
+
+#endif
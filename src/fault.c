@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     fault.c
+ * @brief    LED overcurrent fault brake for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     The FB pin shares P1.4 with the White PWM output, so the brake
+ *           source is the ADC comparator: adc_sense.c enables ADFBEN with
+ *           the channel trip level on every on-phase shunt conversion.
+ *
+ * Fault Path:
+ *   - Shunt sample >= trip level: hardware stops PWM and drives FBD
+ *     levels on the outputs, no CPU involved
+ *   - Brake ISR latches the fault and hands both pins to GPIO (latched
+ *     low), so the outputs stay dark whatever the PWM polarity setting
+ *   - Main loop reports it (DWIN/buzzer); only fault_clear() plus a PWM
+ *     restart through the soft-start ramp turns the light back on
+ ******************************************************************************/
+
+#include "fault.h"
+
+/* TA-protected SFR page select for ISR context (EA already masked) */
+#define SFRPAGE_0_ISR()     TA = 0xAA; TA = 0x55; SFRS = 0
+#define SFRPAGE_1_ISR()     TA = 0xAA; TA = 0x55; SFRS = 1
+
+/* FBD: FBF flag, brake levels for PWM0..5 all low */
+#define FBD_FBF             0x80
+#define FBD_LEVELS_LOW      0x00
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static volatile uint8_t s_code = FAULT_NONE;
+static volatile bit s_new = 0;
+
+/*===========================================================================*/
+/* PWM Fault Brake Interrupt (Vector 14)                                      */
+/*===========================================================================*/
+void Fault_Brake_ISR(void) interrupt 14
+{
+    uint8_t sfrs = SFRS;
+
+    FBD &= ~FBD_FBF;
+
+    /* Pins back to GPIO (latch 0) until the fault is cleared */
+    SFRPAGE_0_ISR();
+    PWM1_P14_OUTPUT_DISABLE;
+    SFRPAGE_1_ISR();
+    PWM5_P15_OUTPUT_DISABLE;
+    TA = 0xAA; TA = 0x55; SFRS = sfrs;
+
+    s_code = FAULT_OVERCURRENT;
+    s_new = 1;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void fault_init(void)
+{
+    /* GPIO levels used while braked */
+    P14 = 0;
+    P15 = 0;
+
+    FBD = FBD_LEVELS_LOW;
+    s_code = FAULT_NONE;
+    s_new = 0;
+
+    set_EIE_EFB;
+}
+
+uint8_t fault_task(void)
+{
+    if (!s_new) return FAULT_NONE;
+
+    s_new = 0;
+    return s_code;
+}
+
+uint8_t fault_code(void)
+{
+    return s_code;
+}
+
+uint8_t fault_clear(void)
+{
+    if (s_code == FAULT_NONE) return 0;
+
+    clr_EIE_EFB;
+    s_code = FAULT_NONE;
+    s_new = 0;
+    FBD &= ~FBD_FBF;
+    PWM1_P14_OUTPUT_ENABLE;
+    set_SFRPAGE;
+    PWM5_P15_OUTPUT_ENABLE;
+    clr_SFRPAGE;
+    set_EIE_EFB;
+
+    return 1;
+}
@@ -0,0 +1,68 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     flash_iap.c
+ * @brief    APROM data storage via IAP for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Only the reserved data area (FLASH_DATA_BASE..FLASH_DATA_END)
+ *           can be erased or programmed through this module, so a bad
+ *           address can never hit program code.
+ ******************************************************************************/
+
+#include "flash_iap.h"
+
+/* CHPCON IAPFF: last IAP command failed */
+#define CHPCON_IAPFF        0x40
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* One IAP command with interrupts masked; returns 1 if it succeeded */
+static uint8_t iap_command(uint8_t cmd, uint16_t addr, uint8_t dat)
+{
+    bit ea_save;
+    uint8_t ok;
+
+    ea_save = EA;
+    EA = 0;
+    FLASH_IAP_ENABLE();
+    FLASH_IAP_GO(cmd, addr, dat);
+    ok = (CHPCON & CHPCON_IAPFF) ? 0 : 1;
+    if (!ok)
+    {
+        TA = 0xAA; TA = 0x55; CHPCON &= ~CHPCON_IAPFF;
+    }
+    FLASH_IAP_DISABLE();
+    EA = ea_save;
+
+    return ok;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+uint8_t flash_iap_erase(uint16_t page)
+{
+    if (page < FLASH_DATA_BASE || page >= FLASH_DATA_END) return 0;
+
+    return iap_command(IAP_APROM_ERASE, page & ~(FLASH_PAGE_SIZE - 1), 0xFF);
+}
+
+uint8_t flash_iap_write(uint16_t addr, uint8_t *src, uint8_t len)
+{
+    if (addr < FLASH_DATA_BASE || addr + len > FLASH_DATA_END) return 0;
+
+    while (len--)
+    {
+        if (!iap_command(IAP_APROM_PROGRAM, addr, *src)) return 0;
+        addr++;
+        src++;
+    }
+
+    return 1;
+}
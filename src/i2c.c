@@ -0,0 +1,171 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     i2c.c
+ * @brief    Interrupt-driven I2C master for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Callers queue I2C_Xfer_t descriptors and poll their status;
+ *           the ISR walks the status codes (I2STAT) of one transfer after
+ *           the other, so the main loop never waits on the bus.
+ *
+ * Transfer:
+ *   START, SLA+W, wr_len bytes, [repeated START, SLA+R, rd_len bytes], STOP
+ *   - The last read byte is NACKed
+ *   - A queued transfer follows with STOP + START in the same step
+ *   - NACK, lost arbitration, bus error: STOP, status I2C_ERROR
+ *   - Hardware time-out (I2TOC, 2.7ms without progress) aborts the same way
+ ******************************************************************************/
+
+#include "i2c.h"
+
+#if I2C_MODE == I2C_MODE_ALS
+
+#define I2C_QUEUE_MASK      (I2C_QUEUE_LEN - 1)
+
+/* I2TOC: time-out enable, Fsys/4 clock (14-bit: 2.7ms), time-out flag */
+#define I2TOC_I2TOCEN       0x04
+#define I2TOC_DIV           0x02
+#define I2TOC_I2TOF         0x01
+
+/* Master status codes */
+#define I2C_ST_START        0x08
+#define I2C_ST_RESTART      0x10
+#define I2C_ST_SLAW_ACK     0x18
+#define I2C_ST_DATA_W_ACK   0x28
+#define I2C_ST_SLAR_ACK     0x40
+#define I2C_ST_DATA_R_ACK   0x50
+#define I2C_ST_DATA_R_NACK  0x58
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static I2C_Xfer_t xdata * xdata s_queue[I2C_QUEUE_LEN];
+static volatile uint8_t s_head = 0;
+static volatile uint8_t s_tail = 0;
+static volatile bit s_busy = 0;
+static uint8_t s_idx = 0;
+
+/*===========================================================================*/
+/* I2C Interrupt (Vector 6)                                                   */
+/*===========================================================================*/
+void I2C_ISR(void) interrupt 6
+{
+    I2C_Xfer_t xdata *x;
+    uint8_t result;
+
+    x = s_queue[s_tail];
+    result = I2C_PENDING;
+
+    if (I2TOC & I2TOC_I2TOF)
+    {
+        I2TOC &= ~I2TOC_I2TOF;
+        result = I2C_ERROR;
+    }
+    else
+    {
+        switch (I2STAT)
+        {
+            case I2C_ST_START:
+                s_idx = 0;
+                I2DAT = (x->addr << 1) | (x->wr_len ? 0 : 1);
+                STA = 0;
+                break;
+
+            case I2C_ST_RESTART:
+                s_idx = 0;
+                I2DAT = (x->addr << 1) | 1;
+                STA = 0;
+                break;
+
+            case I2C_ST_SLAW_ACK:
+            case I2C_ST_DATA_W_ACK:
+                if (s_idx < x->wr_len) I2DAT = x->buf[s_idx++];
+                else if (x->rd_len) STA = 1;
+                else result = I2C_DONE;
+                break;
+
+            case I2C_ST_SLAR_ACK:
+                AA = (x->rd_len > 1) ? 1 : 0;
+                break;
+
+            case I2C_ST_DATA_R_ACK:
+                x->buf[s_idx++] = I2DAT;
+                AA = (s_idx + 1 < x->rd_len) ? 1 : 0;
+                break;
+
+            case I2C_ST_DATA_R_NACK:
+                x->buf[s_idx] = I2DAT;
+                result = I2C_DONE;
+                break;
+
+            default:
+                /* SLA/data NACK, arbitration lost, bus error */
+                result = I2C_ERROR;
+                break;
+        }
+    }
+
+    if (result != I2C_PENDING)
+    {
+        x->status = result;
+        s_tail = (s_tail + 1) & I2C_QUEUE_MASK;
+        STO = 1;
+        if (s_tail != s_head)
+        {
+            STA = 1;
+        }
+        else
+        {
+            I2TOC = 0;
+            s_busy = 0;
+        }
+    }
+
+    SI = 0;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void i2c_init(void)
+{
+    P02 = 1;
+    P16 = 1;
+    P02_OPENDRAIN_MODE;
+    P16_OPENDRAIN_MODE;
+
+    I2CLK = I2C_CLOCK_DIV;
+    set_I2CON_I2CPX;
+    set_I2CON_I2CEN;
+    set_EIE_EI2C;
+}
+
+uint8_t i2c_submit(I2C_Xfer_t xdata *x)
+{
+    uint8_t next;
+
+    next = (s_head + 1) & I2C_QUEUE_MASK;
+    if (next == s_tail) return 0;
+
+    x->status = I2C_PENDING;
+
+    clr_EIE_EI2C;
+    s_queue[s_head] = x;
+    s_head = next;
+    if (!s_busy)
+    {
+        s_busy = 1;
+        I2TOC = I2TOC_I2TOCEN | I2TOC_DIV;
+        STA = 1;
+    }
+    set_EIE_EI2C;
+
+    return 1;
+}
+
+#endif
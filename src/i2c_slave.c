@@ -0,0 +1,222 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     i2c_slave.c
+ * @brief    I2C slave register interface for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Lets a main board in a modular luminaire drive this MCU.
+ *
+ * Host transfers (register pointer auto-increments):
+ *   Write: START, SLA+W, reg, data... STOP
+ *   Read:  START, SLA+W, reg, repeated START, SLA+R, data... NACK, STOP
+ *
+ * Reads: the main loop fills a snapshot of all registers and publishes it
+ * by flipping between two buffers. The ISR latches the published buffer at
+ * SLA+R and serves the whole burst from it, so it never touches main loop
+ * state and a burst is always consistent. A flip is held back while a
+ * read burst is running.
+ *
+ * Writes: the ISR only collects the burst. At STOP it is handed to the
+ * main loop, which validates every byte and applies all of them in one
+ * pass, or none (REJECTS). Until then new writes are NACKed, the host
+ * retries.
+ ******************************************************************************/
+
+#include "i2c_slave.h"
+#include "led_pwm.h"
+#include "preset.h"
+
+#if I2C_MODE == I2C_MODE_SLAVE
+
+/* Slave status codes */
+#define I2CS_ST_SLAW        0x60    /* Own SLA+W, ACKed */
+#define I2CS_ST_RX_ACK      0x80    /* Data received, ACKed */
+#define I2CS_ST_RX_NACK     0x88    /* Data received, NACKed */
+#define I2CS_ST_STOP        0xA0    /* STOP or repeated START */
+#define I2CS_ST_SLAR        0xA8    /* Own SLA+R, ACKed */
+#define I2CS_ST_TX_ACK      0xB8    /* Data sent, ACKed */
+#define I2CS_ST_TX_NACK     0xC0    /* Data sent, NACKed: end of read */
+#define I2CS_ST_TX_LAST     0xC8    /* Last data sent (AA = 0), ACKed */
+
+#define I2CS_READ_ONLY      0xFF
+
+/* Serve the next snapshot byte (0xFF past the map) */
+#define I2CS_TX_NEXT()      do { I2DAT = (s_ptr < I2CS_REG_COUNT) ? s_snap[s_read][s_ptr] : 0xFF; \
+                                 s_ptr++;                                                      \
+                            } while (0)
+
+/* Highest value accepted per register */
+static uint8_t code s_reg_max[I2CS_REG_COUNT] = {
+    1, I2CS_LEVEL_MAX, I2CS_LEVEL_MAX, LED_PWM_PROFILE_COUNT - 1,
+    PRESET_COUNT, PRESET_COUNT, 0,
+    I2CS_READ_ONLY, I2CS_READ_ONLY, I2CS_READ_ONLY, I2CS_READ_ONLY,
+    I2CS_READ_ONLY, I2CS_READ_ONLY
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+/* Read side: published snapshot / snapshot being prepared */
+static uint8_t xdata s_snap[2][I2CS_REG_COUNT];
+static volatile uint8_t s_front = 0;
+static uint8_t s_read = 0;              /* Buffer of the running read burst */
+static volatile bit s_reading = 0;
+
+/* Write side: burst handed from the ISR to the main loop */
+static uint8_t xdata s_rx[I2CS_REG_COUNT];
+static uint8_t s_count = 0;             /* Bytes this write, pointer included */
+static uint8_t s_ptr = 0;
+static uint8_t s_wr_reg = 0;
+static uint8_t s_wr_len = 0;
+static volatile bit s_pending = 0;
+
+/* Main loop */
+static uint8_t xdata s_value[I2CS_REG_COUNT];
+static uint8_t xdata s_writes = 0;
+static uint8_t xdata s_rejects = 0;
+
+/*===========================================================================*/
+/* I2C Interrupt (Vector 6)                                                   */
+/*===========================================================================*/
+void I2C_Slave_ISR(void) interrupt 6
+{
+    uint8_t d;
+
+    switch (I2STAT)
+    {
+        case I2CS_ST_SLAW:
+            s_count = 0;
+            s_reading = 0;
+            AA = s_pending ? 0 : 1;     /* Previous burst not taken yet */
+            break;
+
+        case I2CS_ST_RX_ACK:
+            d = I2DAT;
+            if (s_count == 0) s_ptr = d;
+            else s_rx[s_count - 1] = d;
+            s_count++;
+            AA = (s_count <= I2CS_REG_COUNT) ? 1 : 0;
+            break;
+
+        case I2CS_ST_RX_NACK:
+            AA = 1;
+            break;
+
+        case I2CS_ST_STOP:
+            if (s_count > 1 && !s_pending)
+            {
+                s_wr_reg = s_ptr;
+                s_wr_len = s_count - 1;
+                s_ptr += s_wr_len;
+                s_pending = 1;
+            }
+            s_count = 0;
+            s_reading = 0;
+            AA = 1;
+            break;
+
+        case I2CS_ST_SLAR:
+            s_read = s_front;
+            s_reading = 1;
+            I2CS_TX_NEXT();
+            AA = 1;
+            break;
+
+        case I2CS_ST_TX_ACK:
+            I2CS_TX_NEXT();
+            break;
+
+        case I2CS_ST_TX_NACK:
+        case I2CS_ST_TX_LAST:
+            s_reading = 0;
+            AA = 1;
+            break;
+
+        default:
+            /* Bus error: release the lines */
+            STO = 1;
+            s_reading = 0;
+            AA = 1;
+            break;
+    }
+
+    SI = 0;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void i2c_slave_init(void)
+{
+    P02 = 1;
+    P16 = 1;
+    P02_OPENDRAIN_MODE;
+    P16_OPENDRAIN_MODE;
+
+    I2ADDR = I2CS_ADDR << 1;    /* No general call */
+    set_I2CON_I2CPX;
+    set_I2CON_I2CEN;
+    set_I2CON_AA;
+    set_EIE_EI2C;
+}
+
+void i2c_slave_set(uint8_t reg, uint8_t value)
+{
+    s_snap[s_front ^ 1][reg] = value;
+}
+
+void i2c_slave_publish(void)
+{
+    i2c_slave_set(I2CS_REG_WRITES, s_writes);
+    i2c_slave_set(I2CS_REG_REJECTS, s_rejects);
+
+    clr_EIE_EI2C;
+    if (!s_reading) s_front ^= 1;
+    set_EIE_EI2C;
+}
+
+uint16_t i2c_slave_task(void)
+{
+    uint16_t mask;
+    uint8_t i, reg;
+
+    if (!s_pending) return 0;
+
+    mask = 0;
+    if (s_wr_reg < I2CS_REG_COUNT && s_wr_len <= I2CS_REG_COUNT - s_wr_reg)
+    {
+        for (i = 0; i < s_wr_len; i++)
+        {
+            reg = s_wr_reg + i;
+            if (s_reg_max[reg] == I2CS_READ_ONLY || s_rx[i] > s_reg_max[reg]) break;
+        }
+
+        /* All or nothing */
+        if (i == s_wr_len)
+        {
+            for (i = 0; i < s_wr_len; i++)
+            {
+                s_value[s_wr_reg + i] = s_rx[i];
+                mask |= I2CS_BIT(s_wr_reg + i);
+            }
+        }
+    }
+
+    if (mask) s_writes++;
+    else s_rejects++;
+
+    s_pending = 0;
+    return mask;
+}
+
+uint8_t i2c_slave_get(uint8_t reg)
+{
+    return s_value[reg];
+}
+
+#endif
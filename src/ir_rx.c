@@ -21,6 +21,7 @@
 
 /* ir_rx.h includes all necessary headers (MS51_16K.h, SFR_Macro.h, etc.) */
 #include "ir_rx.h"
+#include "cam_sync.h"
 
 /*===========================================================================*/
 /* NEC IR Protocol Timing Constants (24MHz, Timer0 /12 = 0.5us tick)         */
@@ -28,16 +29,20 @@
 /* 
  * NEC Protocol Timing:
  * - Leader: 9ms mark + 4.5ms space = 13.5ms
+ * - Repeat: 9ms mark + 2.25ms space = 11.25ms (every 108ms while held)
  * - Bit 1:  562.5us mark + 1687.5us space = 2.25ms
  * - Bit 0:  562.5us mark + 562.5us space = 1.125ms
  * 
  * With 0.5us timer tick:
  * - Leader: ~27000 ticks
+ * - Repeat: ~22500 ticks
  * - Bit 1:  ~4500 ticks
  * - Bit 0:  ~2250 ticks
  */
-#define SYNC_MIN        18000   /* ~9ms minimum */
+#define SYNC_MIN        25000   /* ~12.5ms minimum */
 #define SYNC_MAX        30000   /* ~15ms maximum */
+#define REPEAT_MIN      21000   /* ~10.5ms minimum */
+#define REPEAT_MAX      24000   /* ~12ms maximum */
 #define ONE_MIN         3000    /* ~1.5ms minimum */
 #define ONE_MAX         5400    /* ~2.7ms maximum */
 #define ZERO_MIN        1200    /* ~0.6ms minimum */
@@ -51,6 +56,7 @@
 /*===========================================================================*/
 static volatile bit ir_received = 0;        /* Data ready flag */
 static volatile bit ir_started = 0;         /* Reception in progress */
+static volatile bit ir_repeat = 0;          /* Repeat frame seen (key held) */
 static volatile uint8_t bit_count = 0;      /* Bit counter */
 static volatile uint16_t pulse_times[IR_FRAME_BITS];  /* Pulse timing buffer */
 
@@ -64,12 +70,21 @@ static volatile uint16_t pulse_times[IR_FRAME_BITS];  /* Pulse timing buffer */
 
 /*===========================================================================*/
 /* Pin Interrupt ISR for IR reception (P0.5) - OPTIMIZED                      */
-/* Vector 7: Pin interrupt for MS51                                           */
+/* Vector 7: Pin interrupt for MS51 (also dispatches camera sync on P0.1)     */
 /*===========================================================================*/
 void PinInterrupt_ISR(void) interrupt 7
 {
     uint16_t pulse;
     
+#if CAM_SYNC_ENABLE
+    /* Camera frame pulse shares the pin interrupt vector (P0.1) */
+    if (PIF & CAM_SYNC_PIF)
+    {
+        PIF &= ~CAM_SYNC_PIF;
+        cam_sync_edge();
+    }
+#endif
+    
     /* Quick exit if not our pin or already processing complete frame */
     if (!(PIF & 0x20))
     {
@@ -81,6 +96,7 @@ void PinInterrupt_ISR(void) interrupt 7
     pulse = TIMER0_READ();
     TIMER0_RESET();
     TIMER0_START();
+    clr_TF0;    /* Overflow = 32ms since this edge, see is_ir_busy() */
     
     /* Clear interrupt flag early */
     PIF = 0x00;
@@ -98,6 +114,14 @@ void PinInterrupt_ISR(void) interrupt 7
         return;
     }
     
+    /* Repeat leader: key still held, no data follows */
+    if (pulse >= REPEAT_MIN && pulse <= REPEAT_MAX)
+    {
+        ir_repeat = 1;
+        ir_started = 0;
+        return;
+    }
+    
     /* Only process if we've seen the sync */
     if (!ir_started) return;
     
@@ -125,6 +149,7 @@ void EXTI1_ISR(void) interrupt 2
     pulse = TIMER0_READ();
     TIMER0_RESET();
     TIMER0_START();
+    clr_TF0;    /* Overflow = 32ms since this edge, see is_ir_busy() */
     
     if (ir_received) return;
     
@@ -137,6 +162,13 @@ void EXTI1_ISR(void) interrupt 2
         return;
     }
     
+    if (pulse >= REPEAT_MIN && pulse <= REPEAT_MAX)
+    {
+        ir_repeat = 1;
+        ir_started = 0;
+        return;
+    }
+    
     if (!ir_started) return;
     
     pulse_times[bit_count++] = pulse;
@@ -230,6 +262,25 @@ uint8_t is_ir_data_received(void)
     return ir_received;
 }
 
+/*===========================================================================*/
+/* Check for a frame in progress (leader seen, edges less than 32ms apart)    */
+/*===========================================================================*/
+uint8_t is_ir_busy(void)
+{
+    return ir_started && !TF0;
+}
+
+/*===========================================================================*/
+/* Check for an NEC repeat frame (clears the flag)                            */
+/*===========================================================================*/
+uint8_t is_ir_repeat(void)
+{
+    if (!ir_repeat) return 0;
+    
+    ir_repeat = 0;
+    return 1;
+}
+
 /*===========================================================================*/
 /* Get received IR data - OPTIMIZED                                           */
 /* @param buf: Buffer to store decoded data                                   */
@@ -247,6 +298,7 @@ void get_ir_data(uint8_t *buf, uint8_t len)
     
     /* Reset state for next reception */
     ir_received = 0;
+    ir_repeat = 0;
     ir_started = 0;
     bit_count = 0;
     
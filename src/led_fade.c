@@ -0,0 +1,181 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     led_fade.c
+ * @brief    Background slew-limited duty ramps for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Soft start: the main loop only sets targets, the 1ms timebase
+ *           tick moves each channel a fixed step towards its target, so
+ *           IR and DWIN handling never wait on a ramp.
+ *
+ * Ramp Control:
+ *   - Step per ms = |target - level| / ramp_ms rounded up, so both
+ *     channels arrive together and on time; capped at full scale /
+ *     LED_FADE_SLEW_MS (driver inrush)
+ *   - Stagger delays the Yellow ramp so the two channels do not both
+ *     draw their largest current step at the same time
+ *   - led_pwm_set() is called only on ticks where a level moved
+ ******************************************************************************/
+
+#include "led_fade.h"
+#include "led_pwm.h"
+#include "boot_trace.h"
+
+#define FADE_WHITE          0
+#define FADE_YELLOW         1
+#define FADE_CHANNELS       2
+
+typedef struct
+{
+    uint16_t level;     // Current output duty
+    uint16_t target;    // Ramp end point
+    uint16_t step;      // Duty change per ms
+    uint16_t delay;     // ms before the ramp starts
+} Fade_Channel_t;
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static Fade_Channel_t xdata s_ch[FADE_CHANNELS];
+static volatile bit s_busy = 0;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* Step for one channel; caller has the tick masked */
+static void fade_plan(uint8_t ch, uint16_t target, uint16_t ramp_ms, uint16_t slew)
+{
+    uint16_t delta, step;
+
+    delta = (target > s_ch[ch].level) ? (target - s_ch[ch].level) : (s_ch[ch].level - target);
+    /* Rounded up, so the ramp ends within ramp_ms */
+    step = (ramp_ms != 0 && delta != 0) ? ((delta - 1) / ramp_ms + 1) : delta;
+    if (step > slew) step = slew;
+    if (step == 0) step = 1;
+
+    s_ch[ch].target = target;
+    s_ch[ch].step = step;
+}
+
+/*===========================================================================*/
+/* Timebase Tick - ISR context                                                */
+/*===========================================================================*/
+void led_fade_tick(void)
+{
+    uint8_t ch;
+    bit moved = 0;
+    bit pending = 0;
+
+    if (!s_busy) return;
+
+    for (ch = 0; ch < FADE_CHANNELS; ch++)
+    {
+        if (s_ch[ch].delay != 0)
+        {
+            s_ch[ch].delay--;
+            pending = 1;
+            continue;
+        }
+
+        if (s_ch[ch].level < s_ch[ch].target)
+        {
+            if (s_ch[ch].target - s_ch[ch].level > s_ch[ch].step)
+            {
+                s_ch[ch].level += s_ch[ch].step;
+                pending = 1;
+            }
+            else
+            {
+                s_ch[ch].level = s_ch[ch].target;
+            }
+            moved = 1;
+        }
+        else if (s_ch[ch].level > s_ch[ch].target)
+        {
+            if (s_ch[ch].level - s_ch[ch].target > s_ch[ch].step)
+            {
+                s_ch[ch].level -= s_ch[ch].step;
+                pending = 1;
+            }
+            else
+            {
+                s_ch[ch].level = s_ch[ch].target;
+            }
+            moved = 1;
+        }
+    }
+
+    if (moved)
+    {
+        led_pwm_set(s_ch[FADE_WHITE].level, s_ch[FADE_YELLOW].level);
+#if BOOT_TRACE_ENABLE
+        if (s_ch[FADE_WHITE].level | s_ch[FADE_YELLOW].level) boot_trace_light();
+#endif
+    }
+    s_busy = pending;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void led_fade_init(void)
+{
+    uint8_t ch;
+
+    clr_EIE_ET2;
+    for (ch = 0; ch < FADE_CHANNELS; ch++)
+    {
+        s_ch[ch].level = 0;
+        s_ch[ch].target = 0;
+        s_ch[ch].step = 1;
+        s_ch[ch].delay = 0;
+    }
+    s_busy = 0;
+    set_EIE_ET2;
+}
+
+void led_fade_to(uint16_t white, uint16_t yellow, uint16_t ramp_ms, uint16_t stagger_ms)
+{
+    uint16_t slew;
+
+    slew = led_pwm_full_scale() / LED_FADE_SLEW_MS;
+
+    clr_EIE_ET2;
+    fade_plan(FADE_WHITE, white, ramp_ms, slew);
+    fade_plan(FADE_YELLOW, yellow, ramp_ms, slew);
+    s_ch[FADE_WHITE].delay = 0;
+    s_ch[FADE_YELLOW].delay = stagger_ms;
+    s_busy = 1;
+    set_EIE_ET2;
+}
+
+void led_fade_jump(uint16_t white, uint16_t yellow)
+{
+    uint8_t ch;
+
+    clr_EIE_ET2;
+    s_ch[FADE_WHITE].target = white;
+    s_ch[FADE_YELLOW].target = yellow;
+    for (ch = 0; ch < FADE_CHANNELS; ch++)
+    {
+        s_ch[ch].step = 0xFFFF;
+        s_ch[ch].delay = 0;
+    }
+    s_busy = 1;
+    set_EIE_ET2;
+}
+
+void led_fade_reset(void)
+{
+    led_fade_init();
+}
+
+uint8_t led_fade_busy(void)
+{
+    return s_busy;
+}
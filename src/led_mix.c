@@ -0,0 +1,108 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     led_mix.c
+ * @brief    Constant-lumen White/Yellow CCT mixing model for MS51FB9AE
+ * @version  1.0.0
+ * @note     Flux = intensity is split by the warm share, each share is
+ *           divided by the channel efficacy (gain), then both duties are
+ *           scaled down together if a channel saturates or the combined
+ *           power budget is exceeded. Scaling both keeps the CCT.
+ *
+ * Cycle Budget:
+ *   - Warm-dependent coefficients and intensity ceiling are computed once
+ *     per CCT change (32-bit divide, slow path)
+ *   - Per-update path: one compare + two 16x8 multiplies built from
+ *     MUL AB, no library long arithmetic
+ ******************************************************************************/
+
+#include "led_mix.h"
+
+#define MIX_WARM_INVALID    0xFF
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static uint16_t s_full_scale = 0;           /* Channel 100% duty (counts) */
+static uint8_t  s_warm = MIX_WARM_INVALID;  /* Blend the cache was built for */
+static uint8_t  s_coef_white = 0;           /* White duty per unit flux, Q7 */
+static uint8_t  s_coef_yellow = 0;          /* Yellow duty per unit flux, Q7 */
+static uint16_t s_i_max = 0;                /* Intensity ceiling for s_warm */
+
+/*===========================================================================*/
+/* 16x8 -> 16 Q7 multiply using two 8x8 hardware multiplies                   */
+/* (a * f) >> 7 == ((a_hi * f) << 1) + ((a_lo * f) >> 7)                     */
+/*===========================================================================*/
+static uint16_t mix_mul_q7(uint16_t a, uint8_t f)
+{
+    uint16_t hi, lo;
+
+    hi = (uint16_t)(uint8_t)(a >> 8) * f;
+    lo = (uint16_t)(uint8_t)(a) * f;
+
+    return (hi << 1) + (lo >> 7);
+}
+
+/*===========================================================================*/
+/* Rebuild blend coefficients and intensity ceiling (slow path)               */
+/*===========================================================================*/
+static void mix_prepare(uint8_t warm)
+{
+    uint32_t ceiling;
+    uint32_t limit;
+    uint16_t power_q7;
+
+    s_coef_white  = (uint8_t)(((uint16_t)MIX_GAIN_WHITE_Q7 * (MIX_WARM_FULL - warm)) >> 7);
+    s_coef_yellow = (uint8_t)(((uint16_t)MIX_GAIN_YELLOW_Q7 * warm) >> 7);
+
+    ceiling = 0xFFFF;
+
+    /* Neither channel may exceed full scale */
+    if (s_coef_white)
+    {
+        limit = ((uint32_t)s_full_scale << 7) / s_coef_white;
+        if (limit < ceiling) ceiling = limit;
+    }
+    if (s_coef_yellow)
+    {
+        limit = ((uint32_t)s_full_scale << 7) / s_coef_yellow;
+        if (limit < ceiling) ceiling = limit;
+    }
+
+    /* Combined power per unit flux, Q7 */
+    power_q7 = (uint16_t)(((uint16_t)s_coef_white * MIX_POWER_WHITE_Q7 +
+                           (uint16_t)s_coef_yellow * MIX_POWER_YELLOW_Q7) >> 7);
+    if (power_q7)
+    {
+        limit = ((uint32_t)s_full_scale * (uint16_t)MIX_POWER_LIMIT_Q7) / power_q7;
+        if (limit < ceiling) ceiling = limit;
+    }
+
+    s_i_max = (uint16_t)ceiling;
+    s_warm = warm;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void led_mix_init(uint16_t full_scale)
+{
+    s_full_scale = full_scale;
+    s_warm = MIX_WARM_INVALID;
+}
+
+void led_mix_compute(uint16_t intensity, uint8_t warm, LED_Duty_t *out)
+{
+    if (warm > MIX_WARM_FULL) warm = MIX_WARM_FULL;
+    if (warm != s_warm) mix_prepare(warm);
+
+    if (intensity > s_i_max) intensity = s_i_max;
+
+    out->white  = mix_mul_q7(intensity, s_coef_white);
+    out->yellow = mix_mul_q7(intensity, s_coef_yellow);
+}
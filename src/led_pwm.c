@@ -0,0 +1,379 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     led_pwm.c
+ * @brief    White/Yellow LED PWM output stage for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     PWM1 (P1.4) = White, PWM5 (P1.5) = Yellow
+ *
+ * Temporal Dithering:
+ *   - Duty carries LED_DUTY_FRAC_BITS below one PWM count
+ *   - PWM period interrupt runs a first-order sigma-delta per channel:
+ *     the fraction is accumulated and each carry loads count+1 for one
+ *     period, so the average duty hits the fraction exactly
+ *   - 4 fraction bits turn 1/1110 steps into 1/17760 without lowering
+ *     the PWM frequency
+ *
+ * PWM Profiles:
+ *   - Clock divider + period per profile in a code table, switchable at
+ *     runtime; led_pwm_full_scale() reports 100% duty for LUT rescaling
+ *
+ * Interleaving (duty complementing):
+ *   - Edge-aligned outputs all go high at period start, so both LED
+ *     currents add up in one pulse. With interleave on, PWM5 polarity is
+ *     inverted and its compare value is written as (P + 1 - duty): Yellow
+ *     conducts during the last 'duty' counts of the period while White
+ *     conducts during the first, and the intervals meet end to end
+ *
+ * ADC Trigger Mirrors:
+ *   - The ADC external trigger only taps PWM0/2/4, so PWM0 and PWM4 are
+ *     loaded with the White/Yellow compare values (outputs not enabled)
+ *     and mark the on-phase edges for current sampling
+ *
+ * Period Stamping:
+ *   - On request the period ISR also records the timebase counter at each
+ *     period boundary, used as phase reference by camera sync
+ *   - Like dithering, not on profiles where the period ISR is too costly
+ *     (43K: ~25% CPU); camera sync then stays free running
+ ******************************************************************************/
+
+#include "led_pwm.h"
+#include "timebase.h"
+
+/* TA-protected SFR page select for ISR context (EA already masked) */
+#define SFRPAGE_0_ISR()     TA = 0xAA; TA = 0x55; SFRS = 0
+#define SFRPAGE_1_ISR()     TA = 0xAA; TA = 0x55; SFRS = 1
+
+/* PWMINTC (page 1): interrupt at end of PWM period, channel 0 */
+#define PWM_INT_END_OF_PERIOD   0x30
+
+/* PNP bit for PWM5 (Yellow) */
+#define PNP_YELLOW              0x20
+
+/*
+ * Context rules (C51 functions are not reentrant):
+ *   - led_pwm_set() is called from the timebase ISR only (fade engine)
+ *   - All other API runs in the main loop inside PWM_ENTER/PWM_EXIT
+ *   - Register loads are inline macros, never a shared function
+ */
+#define PWM_ENTER()             ea_save = EA; EA = 0
+#define PWM_EXIT()              EA = ea_save
+
+/* Yellow compare value: complemented against the live period when interleaved */
+#define YELLOW_REG(y)           (s_interleave ? (((y) > s_period_now) ? 0 : (s_period_now + 1 - (y))) : (y))
+
+/* PWMCON1 PWMDIV[2:0] codes */
+#define PWM_DIV_1               0x00
+#define PWM_DIV_8               0x03
+#define PWM_DIV_MASK            0x07
+
+/*===========================================================================*/
+/* PWM Profile Table                                                          */
+/*===========================================================================*/
+typedef struct
+{
+    uint8_t div;        // PWMCON1 clock divider code
+    uint16_t period;    // PWMPH:PWMPL
+    uint8_t period_isr; // Period ISR affordable: dithering, stamping
+} PWM_Profile_t;
+
+static PWM_Profile_t code s_profiles[LED_PWM_PROFILE_COUNT] = {
+    { PWM_DIV_8, 0x0456, 1 },   /* 2.70kHz, 10.1 bit */
+    { PWM_DIV_1, 1142,   1 },   /* 21.0kHz, 10.2 bit */
+    { PWM_DIV_1, 557,    0 },   /* 43.0kHz,  9.1 bit */
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static bit s_dither = 0;
+static bit s_dither_req = 0;
+static bit s_stamp = 0;
+static bit s_stamp_req = 0;
+static bit s_interleave = 0;
+static volatile uint16_t s_period_now = 0;  /* PWMP incl. camera trim */
+static volatile uint16_t s_period_stamp = 0;
+static uint8_t s_profile = LED_PWM_PROFILE_DEFAULT;
+volatile uint8_t data g_led_pwm_shift = 0;
+
+/* Staged duty: integer counts + fraction */
+static volatile uint16_t s_white_int = 0;
+static volatile uint16_t s_yellow_int = 0;
+static volatile uint8_t s_white_frac = 0;
+static volatile uint8_t s_yellow_frac = 0;
+
+/* Sigma-delta error accumulators (ISR only) */
+static uint8_t s_white_acc = 0;
+static uint8_t s_yellow_acc = 0;
+
+/*===========================================================================*/
+/* Register writes (interrupts masked or ISR context)                         */
+/*===========================================================================*/
+#if LED_PWM_ADC_MIRROR
+/* PWM0/PWM4 carry the same compare values, polarity never inverted */
+#define PWM_MIRROR_0(w)         PWM0L = (uint8_t)(w); PWM0H = (uint8_t)((w) >> 8)
+#define PWM_MIRROR_1(y)         PWM4L = (uint8_t)(y); PWM4H = (uint8_t)((y) >> 8)
+#else
+#define PWM_MIRROR_0(w)
+#define PWM_MIRROR_1(y)
+#endif
+
+#define PWM_LOAD_DUTY(w, y) do { uint8_t _sfrs = SFRS;                          \
+                                 uint16_t _y = YELLOW_REG(y);                   \
+                                 SFRPAGE_0_ISR();                               \
+                                 PWM1L = (uint8_t)(w);                          \
+                                 PWM1H = (uint8_t)((w) >> 8);                   \
+                                 PWM_MIRROR_0(w);                               \
+                                 SFRPAGE_1_ISR();                               \
+                                 PWM5L = (uint8_t)(_y);                         \
+                                 PWM5H = (uint8_t)(_y >> 8);                    \
+                                 PWM_MIRROR_1(_y);                              \
+                                 TA = 0xAA; TA = 0x55; SFRS = _sfrs;            \
+                                 LOAD = 1;                                      \
+                            } while (0)
+
+/* Re-evaluate dithering and the period ISR after a mode change (main loop) */
+static void pwm_mode_update(void)
+{
+    clr_EIE_EPWM;
+
+    s_dither = s_dither_req && s_profiles[s_profile].period_isr;
+    s_stamp = s_stamp_req && s_profiles[s_profile].period_isr;
+    s_white_acc = 0;
+    s_yellow_acc = 0;
+    if (!s_dither)
+    {
+        s_white_frac = 0;
+        s_yellow_frac = 0;
+    }
+    PWM_LOAD_DUTY(s_white_int, s_yellow_int);
+
+    /* Period ISR is needed for dithering and/or period stamping */
+    if (s_dither || s_stamp)
+    {
+        PWMF = 0;
+        set_EIE_EPWM;
+    }
+}
+
+/*===========================================================================*/
+/* PWM Period Interrupt - sigma-delta dither (Vector 13)                     */
+/*===========================================================================*/
+void PWM_ISR(void) interrupt 13
+{
+    uint16_t white, yellow;
+
+    PWMF = 0;
+
+    if (s_stamp)
+    {
+        TIMEBASE_READ(s_period_stamp);
+    }
+
+    if (!s_dither) return;
+
+    white = s_white_int;
+    s_white_acc += s_white_frac;
+    if (s_white_acc > LED_DUTY_FRAC_MASK)
+    {
+        s_white_acc &= LED_DUTY_FRAC_MASK;
+        white++;
+    }
+
+    yellow = s_yellow_int;
+    s_yellow_acc += s_yellow_frac;
+    if (s_yellow_acc > LED_DUTY_FRAC_MASK)
+    {
+        s_yellow_acc &= LED_DUTY_FRAC_MASK;
+        yellow++;
+    }
+
+    /* Main loop may be mid set_SFRPAGE/clr_SFRPAGE - macro restores its page */
+    PWM_LOAD_DUTY(white, yellow);
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void led_pwm_init(void)
+{
+    PWM1_P14_OUTPUT_ENABLE;
+    set_SFRPAGE;                    /* PIOCON1 is on page 1 */
+    PWM5_P15_OUTPUT_ENABLE;
+    clr_SFRPAGE;
+    PWM_IMDEPENDENT_MODE;
+    PWM_EDGE_TYPE;
+    PWM_CLOCK_FSYS;
+    PWM_OUTPUT_ALL_NORMAL;
+
+    set_SFRPAGE;
+    PWMINTC = PWM_INT_END_OF_PERIOD;
+    clr_SFRPAGE;
+
+    /* Polarity before the first duty write, so Yellow never flashes */
+    s_interleave = LED_INTERLEAVE_DEFAULT;
+    if (s_interleave) PNP |= PNP_YELLOW;
+
+    s_dither_req = LED_DITHER_DEFAULT;
+    led_pwm_profile(LED_PWM_PROFILE_DEFAULT);
+}
+
+uint8_t led_pwm_profile(uint8_t profile)
+{
+    bit ea_save;
+    uint16_t period;
+
+    if (profile >= LED_PWM_PROFILE_COUNT) return 0;
+
+    PWM_ENTER();
+    clr_PWMRUN;
+
+    s_profile = profile;
+    period = s_profiles[profile].period;
+
+    PWMCON1 = (PWMCON1 & ~PWM_DIV_MASK) | s_profiles[profile].div;
+    g_led_pwm_shift = s_profiles[profile].div;
+    s_period_now = period;
+    PWMPL = (uint8_t)(period);
+    PWMPH = (uint8_t)(period >> 8);
+    set_CLRPWM;
+
+    s_white_int = 0;
+    s_yellow_int = 0;
+    s_white_frac = 0;
+    s_yellow_frac = 0;
+    pwm_mode_update();
+
+    set_PWMRUN;
+    PWM_EXIT();
+    return 1;
+}
+
+uint8_t led_pwm_get_profile(void)
+{
+    return s_profile;
+}
+
+uint16_t led_pwm_full_scale(void)
+{
+    return s_profiles[s_profile].period << LED_DUTY_FRAC_BITS;
+}
+
+uint16_t led_pwm_period(void)
+{
+    return s_profiles[s_profile].period;
+}
+
+uint8_t led_pwm_clock_shift(void)
+{
+    return s_profiles[s_profile].div;
+}
+
+void led_pwm_set(uint16_t white, uint16_t yellow)
+{
+    if (s_dither)
+    {
+        /* Picked up by the next period interrupt */
+        s_white_int = white >> LED_DUTY_FRAC_BITS;
+        s_white_frac = (uint8_t)white & LED_DUTY_FRAC_MASK;
+        s_yellow_int = yellow >> LED_DUTY_FRAC_BITS;
+        s_yellow_frac = (uint8_t)yellow & LED_DUTY_FRAC_MASK;
+    }
+    else
+    {
+        /* Round to nearest count */
+        s_white_int = (white + (1 << (LED_DUTY_FRAC_BITS - 1))) >> LED_DUTY_FRAC_BITS;
+        s_yellow_int = (yellow + (1 << (LED_DUTY_FRAC_BITS - 1))) >> LED_DUTY_FRAC_BITS;
+        PWM_LOAD_DUTY(s_white_int, s_yellow_int);
+    }
+}
+
+void led_pwm_dither(uint8_t enable)
+{
+    bit ea_save;
+
+    PWM_ENTER();
+    s_dither_req = enable ? 1 : 0;
+    pwm_mode_update();
+    PWM_EXIT();
+}
+
+void led_pwm_interleave(uint8_t enable)
+{
+    bit ea_save;
+
+    PWM_ENTER();
+    s_interleave = enable ? 1 : 0;
+    if (s_interleave)
+    {
+        PNP |= PNP_YELLOW;
+    }
+    else
+    {
+        PNP &= ~PNP_YELLOW;
+    }
+    pwm_mode_update();
+    PWM_EXIT();
+}
+
+uint8_t led_pwm_interleaved(void)
+{
+    return s_interleave;
+}
+
+uint16_t led_pwm_counts_white(void)
+{
+    return s_white_int;
+}
+
+uint16_t led_pwm_counts_yellow(void)
+{
+    return s_yellow_int;
+}
+
+void led_pwm_counts(uint16_t *white, uint16_t *yellow)
+{
+    clr_EIE_ET2;
+    *white = s_white_int;
+    *yellow = s_yellow_int;
+    set_EIE_ET2;
+}
+
+void led_pwm_stamp(uint8_t enable)
+{
+    bit ea_save;
+
+    PWM_ENTER();
+    s_stamp_req = enable ? 1 : 0;
+    pwm_mode_update();
+    PWM_EXIT();
+}
+
+uint8_t led_pwm_stamping(void)
+{
+    return s_stamp;
+}
+
+uint16_t led_pwm_period_stamp(void)
+{
+    return s_period_stamp;
+}
+
+void led_pwm_trim_period(uint16_t period)
+{
+    bit ea_save;
+
+    if (period == 0) period = s_profiles[s_profile].period;
+
+    PWM_ENTER();
+    s_period_now = period;
+    PWMPL = (uint8_t)(period);
+    PWMPH = (uint8_t)(period >> 8);
+    PWM_LOAD_DUTY(s_white_int, s_yellow_int);
+    PWM_EXIT();
+}
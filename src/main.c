@@ -15,8 +15,10 @@
  * Architecture:
  *   - UART RX Interrupt for DWIN auto-upload frame processing
  *   - Ring buffer for incoming DWIN frames
+ *   - Ring buffer for outgoing DWIN writes, sent from the TX interrupt
  *   - Non-blocking frame parser
  *   - IR interrupt for remote control
+ *   - Boot: light first, beep and display sync run later from the loop
  ******************************************************************************/
 
 /* Include local headers - following legacy project structure */
@@ -26,6 +28,27 @@
 #include "Common.h"
 #include "Delay.h"
 #include "ir_rx.h"
+#include "led_mix.h"
+#include "led_pwm.h"
+#include "led_fade.h"
+#include "timebase.h"
+#include "cam_sync.h"
+#include "thermal.h"
+#include "adc_sense.h"
+#include "current_loop.h"
+#include "fault.h"
+#include "preset.h"
+#include "state_store.h"
+#include "bod_save.h"
+#include "warm_state.h"
+#include "boot_trace.h"
+#include "watchdog.h"
+#include "uart1.h"
+#include "bus_link.h"
+#include "modbus.h"
+#include "dmx.h"
+#include "als.h"
+#include "i2c_slave.h"
 
 /*===========================================================================*/
 /* Configuration Macros                                                       */
@@ -33,6 +56,33 @@
 #define BuzzerPin           P04
 #define MAX_BRIGHTNESS      10
 #define MAX_CCT             10
+#define BEEP_ON_MS          2       /* Buzzer on time per beep */
+#define BEEP_GAP_MS         80      /* Silence between queued beeps */
+#define DMX_RAMP_MS         25      /* Just over one DMX packet period (44 Hz) */
+
+/* Backlight auto-dim: after BACKLIGHT_IDLE_MIN without touch or IR input,
+   step down by BACKLIGHT_STEP_PCT per BACKLIGHT_STEP_MS to the floor */
+#define BACKLIGHT_FULL_PCT  100
+#define BACKLIGHT_IDLE_MIN  5
+#define BACKLIGHT_DIM_PCT   20
+#define BACKLIGHT_STEP_PCT  10
+#define BACKLIGHT_STEP_MS   1000
+
+/* Trend curves: one point per channel every TREND_SAMPLE_MS, sent in
+   batches of TREND_BATCH points per channel (one frame per batch) */
+#ifndef TREND_ENABLE
+#define TREND_ENABLE        1
+#endif
+#define TREND_SAMPLE_MS     100
+#define TREND_BATCH         8
+#define TREND_CH_WHITE      0       /* Duty, per-mille */
+#define TREND_CH_YELLOW     1       /* Duty, per-mille */
+#define TREND_CH_TEMP       2       /* Heatsink, deg C */
+#if THERMAL_ENABLE
+#define TREND_CHANNELS      3
+#else
+#define TREND_CHANNELS      2
+#endif
 
 /*===========================================================================*/
 /* DWIN Display VP Addresses                                                  */
@@ -43,14 +93,28 @@
 #define ADDR_MEMONE         0x1300
 #define ADDR_MEMTWO         0x1400
 #define ADDR_ENDO_MAX       0x1600
+#define ADDR_PWM_PROFILE    0x1700
+#define ADDR_CAM_SYNC       0x1800
+#define ADDR_FAULT          0x1900
+#define ADDR_BOD_COST       0x1A00
+#define ADDR_BOOT_LIGHT     0x1B00
+#define ADDR_BOOT_SYNC      0x1C00
+#define ADDR_RESET_CAUSE    0x1D00
+#define ADDR_WDT_MISSES     0x1E00
+#define ADDR_VP_SKIPPED     0x1F00
 #define ADDR_SCR            0x2000
+#define ADDR_TREND          0x2100
+#define ADDR_CURVE_BUF      0x0310  /* DWIN curve buffer write register */
 
 /*===========================================================================*/
 /* DWIN Frame Processing - Ring Buffer for UART RX                            */
 /*===========================================================================*/
 #define RX_BUFFER_SIZE      32      /* Ring buffer size (power of 2) */
 #define RX_BUFFER_MASK      (RX_BUFFER_SIZE - 1)
+#define TX_BUFFER_SIZE      128     /* Holds the whole boot sync (power of 2) */
+#define TX_BUFFER_MASK      (TX_BUFFER_SIZE - 1)
 #define FRAME_TIMEOUT_MS    50      /* Max time to receive complete frame */
+#define VP_SKIPPED_REPORT_MS 1000   /* Min interval for ADDR_VP_SKIPPED updates */
 #define MAX_FRAME_LEN       12      /* Maximum expected DWIN frame length */
 
 #define DWIN_HEADER_H       0x5A
@@ -58,6 +122,24 @@
 #define DWIN_CMD_WRITE      0x82
 #define DWIN_CMD_READ_RESP  0x83
 
+/* Display sync states (boot and reconnect) */
+#define DISPLAY_SYNC_PENDING 0
+#define DISPLAY_SYNC_SENDING 1
+#define DISPLAY_SYNC_DONE   2
+
+/* Link check: read the current page register, expect a 0x83 reply */
+#define DWIN_PING_VP        0x0014  /* PIC_NOW system VP */
+#define DWIN_PING_MS        250     /* Ping interval */
+#define DWIN_PING_TIMEOUT_MS 100    /* Reply window */
+#define DWIN_LINK_MISSES    3       /* Unanswered pings = panel gone */
+
+/* Watchdog check-in, compiled out with the supervisor */
+#if WATCHDOG_ENABLE
+#define WATCHDOG_CHECKIN(t) watchdog_checkin(t)
+#else
+#define WATCHDOG_CHECKIN(t)
+#endif
+
 /* DWIN frame states */
 #define FRAME_IDLE          0
 #define FRAME_GOT_5A        1
@@ -70,6 +152,12 @@ static volatile uint8_t xdata rx_buffer[RX_BUFFER_SIZE];
 static volatile uint8_t rx_head = 0;
 static volatile uint8_t rx_tail = 0;
 
+/* Ring buffer for UART TX - filled by writeVP(), drained by UART0_ISR */
+static uint8_t xdata tx_buffer[TX_BUFFER_SIZE];
+static volatile uint8_t tx_head = 0;
+static volatile uint8_t tx_tail = 0;
+static volatile bit tx_busy = 0;
+
 /* Frame parsing state - use XDATA */
 static uint8_t frame_state = FRAME_IDLE;
 static uint8_t xdata frame_buffer[MAX_FRAME_LEN];
@@ -77,18 +165,21 @@ static uint8_t frame_idx = 0;
 static uint8_t frame_len = 0;
 static uint16_t frame_timeout_cnt = 0;
 
-/* Parsed frame data */
-static volatile bit g_frame_ready = 0;
-static volatile uint16_t g_frame_addr = 0;
-static volatile uint16_t g_frame_value = 0;
-
 /*===========================================================================*/
-/* PWM Configuration                                                          */
+/* Dimming Tables                                                             */
 /*===========================================================================*/
-#define PWM_PERIOD          0x0456
+/* Total flux per brightness level, per-mille of one channel at full duty;
+   level 10 is both channels at 90%, the original Max output */
+static uint16_t code dim_permille[11] = {
+    0, 178, 358, 538, 718, 898, 1080, 1260, 1440, 1620, 1800
+};
+
+/* dim_permille rescaled to the active PWM profile (counts << FRAC_BITS) */
+static uint16_t xdata pwm_lut[11];
 
-static uint16_t code pwm_lut[11] = {
-    0, 99, 199, 299, 399, 499, 599, 699, 799, 899, 999
+/* Yellow share per CCT level, Q7 (0 = all white, 128 = all yellow) */
+static uint8_t code cct_warm_lut[11] = {
+    0, 13, 26, 38, 51, 64, 77, 90, 102, 115, 128
 };
 
 /*===========================================================================*/
@@ -103,14 +194,55 @@ static uint16_t code pwm_lut[11] = {
 #define IR_CMD_MAX          0xD9
 #define IR_CMD_MEM2         0xC1
 
+/* Preset keys: short press recalls, holding stores the current setting */
+#define IR_HOLD_NONE        0xFF
+#define IR_HOLD_REPEATS     14      /* NEC repeats (108ms) -> ~1.5s hold */
+#define IR_RELEASE_MS       150     /* No repeat for this long = released */
+
+/* DWIN preset buttons send their key value | DWIN_KEY_HOLD on long press */
+#define DWIN_KEY_HOLD       0x80
+
 /*===========================================================================*/
 /* State Variables                                                            */
 /*===========================================================================*/
 static bit g_power = 0;
-static uint8_t g_brightness = 7;
+static bit g_lit = 0;           /* Power state the output is ramping to */
+static uint8_t g_brightness = 5;
 static uint8_t g_cct = 3;
-static uint8_t g_prev_scr = 0;
+static uint8_t g_prev_scr = 0;       /* User backlight level 1-10, 0 = not set */
+static uint8_t xdata g_backlight = BACKLIGHT_FULL_PCT;
+static bit g_dimmed = 0;            /* Backlight lowered by the auto-dim */
+#if UART1_MODE == UART1_MODE_MODBUS || I2C_MODE == I2C_MODE_SLAVE
+static bit g_pwm_hold = 0;          /* Remote burst being applied, see hold_PWM() */
+static bit g_pwm_stale = 0;         /* Output update held back by the burst */
+static uint16_t xdata g_pwm_held_ms = 0;
+#endif
+static uint16_t xdata g_idle_steps = 0;
+static uint16_t xdata g_idle_tick_ms = 0;
+#if TREND_ENABLE
+static uint8_t g_trend = 0;         /* Streaming on (VP shadow) */
+static uint8_t xdata g_trend_count = 0;
+static uint16_t xdata g_trend_ms = 0;
+static uint16_t xdata g_trend_dropped = 0;
+static uint16_t xdata trend_buf[TREND_CHANNELS][TREND_BATCH];
+#endif
 static uint8_t ir_data[IR_DATA_LEN];
+static uint8_t xdata ir_hold_preset = IR_HOLD_NONE;
+static uint8_t xdata ir_hold_repeats = 0;
+static uint16_t xdata ir_hold_ms = 0;
+static uint8_t xdata g_beeps = 0;         /* Beeps still to sound */
+static uint16_t xdata g_beep_ms = 0;
+static uint8_t xdata g_display_sync = DISPLAY_SYNC_PENDING;
+static bit g_link_up = 1;
+static bit g_ping_wait = 0;
+static uint8_t xdata g_ping_misses = 0;
+static uint16_t xdata g_ping_ms = 0;
+static uint16_t xdata g_bod_cost = 0;
+#if UART1_MODE == UART1_MODE_DMX
+static bit g_dmx_live = 0;          /* DMX levels override the local state */
+static uint16_t xdata g_dmx_intensity = 0;
+static uint8_t xdata g_dmx_warm = 0;
+#endif
 
 /*===========================================================================*/
 /* Function Prototypes                                                        */
@@ -118,17 +250,69 @@ static uint8_t ir_data[IR_DATA_LEN];
 static void GPIO_Init(void);
 static void UART_Init(void);
 static void MODIFY_HIRC_24576(void);
-static void PWM_Init(void);
 static void Beep(void);
+static void process_Beep(void);
 static void update_PWM(void);
+static void fade_PWM(uint16_t ramp_ms);
+static void recall_Preset(uint8_t idx);
+static void store_Preset(uint8_t idx);
+static uint8_t restore_State(void);
+static uint8_t load_State(State_t *st);
+static void get_State(State_t *st);
+static void restore_Warm(State_t *st);
+static void save_State(void);
+#if ADC_ISENSE_ENABLE || I2C_MODE == I2C_MODE_ALS
+static uint16_t scale_Duty(uint16_t duty, uint16_t gain);
+#endif
+static void apply_PWM_Profile(uint8_t profile);
 static void sync_Display(void);
+static void process_Display_Sync(void);
+static void process_DWIN_Link(void);
+#if UART1_MODE == UART1_MODE_LINK
+static void process_Bus_Link(void);
+#endif
+#if UART1_MODE == UART1_MODE_MODBUS
+static void process_Modbus(void);
+#endif
+#if I2C_MODE == I2C_MODE_SLAVE
+static void process_I2C_Slave(void);
+#endif
+#if UART1_MODE == UART1_MODE_MODBUS || I2C_MODE == I2C_MODE_SLAVE
+static void apply_Remote_VP(uint16_t address, uint16_t value);
+static void hold_PWM(void);
+static void release_PWM(void);
+#endif
+#if UART1_MODE == UART1_MODE_DMX
+static void process_DMX(void);
+#endif
+static void link_Alive(void);
+static void readVP(uint16_t address, uint8_t words);
+static void tx_write(uint8_t d);
 static void writeVP(uint16_t address, uint16_t value);
 static void setPage(uint8_t page);
 static void writeScr(uint8_t value);
+static void set_Backlight(uint8_t pct);
+static void wake_Backlight(void);
+static void process_Backlight(void);
+#if TREND_ENABLE
+static uint16_t duty_Permille(uint16_t counts, uint16_t full);
+static void process_Trend(void);
+static void send_Trend(void);
+#endif
 static void process_IR(void);
+static void process_IR_Hold(void);
 static void reset_frame_parser(void);
 static void process_DWIN_Frames(void);
-static void handle_DWIN_VP(uint16_t address, uint16_t value);
+static void handle_DWIN_VP(uint8_t idx, uint16_t value);
+static uint8_t find_VP(uint16_t address);
+static void queue_VP(uint16_t address, uint16_t value);
+static void dispatch_Pending_VPs(void);
+static void dispatch_VP(uint8_t handler, uint16_t address, uint8_t value);
+static void key_Preset(uint16_t address, uint8_t key, uint8_t idx);
+#if FAULT_BRAKE_ENABLE
+static void process_Fault(void);
+static void clear_Fault(void);
+#endif
 
 /*===========================================================================*/
 /* UART0 Receive Interrupt Service Routine                                    */
@@ -151,6 +335,16 @@ void UART0_ISR(void) interrupt 4
     if (TI)
     {
         TI = 0;
+        
+        if (tx_tail != tx_head)
+        {
+            SBUF = tx_buffer[tx_tail];
+            tx_tail = (tx_tail + 1) & TX_BUFFER_MASK;
+        }
+        else
+        {
+            tx_busy = 0;
+        }
     }
 }
 
@@ -171,6 +365,25 @@ static uint8_t rx_read(void)
     return d;
 }
 
+/* Queue one byte; waits only while the ring is full */
+static void tx_write(uint8_t d)
+{
+    uint8_t next_head;
+    next_head = (tx_head + 1) & TX_BUFFER_MASK;
+    
+    while (next_head == tx_tail);
+    
+    tx_buffer[tx_head] = d;
+    tx_head = next_head;
+    
+    /* Idle transmitter: raise TI so the ISR sends the first byte */
+    if (!tx_busy)
+    {
+        tx_busy = 1;
+        TI = 1;
+    }
+}
+
 /*===========================================================================*/
 /* DWIN Frame Parser with Timeout Protection                                  */
 /*===========================================================================*/
@@ -259,14 +472,16 @@ static void process_DWIN_Frames(void)
                 {
                     /* Complete frame received */
                     uint8_t cmd = frame_buffer[3];
+                    link_Alive();
                     if (cmd == DWIN_CMD_READ_RESP || cmd == DWIN_CMD_WRITE)
                     {
-                        g_frame_addr = ((uint16_t)frame_buffer[4] << 8) | frame_buffer[5];
                         /* For auto-upload: 5A A5 Len Cmd AddrH AddrL Count DataH DataL */
-                        if (frame_len >= 5)
+                        if (frame_len >= 5 && !(cmd == DWIN_CMD_READ_RESP &&
+                            frame_buffer[4] == (uint8_t)(DWIN_PING_VP >> 8) &&
+                            frame_buffer[5] == (uint8_t)DWIN_PING_VP))
                         {
-                            g_frame_value = ((uint16_t)frame_buffer[7] << 8) | frame_buffer[8];
-                            g_frame_ready = 1;
+                            queue_VP(((uint16_t)frame_buffer[4] << 8) | frame_buffer[5],
+                                     ((uint16_t)frame_buffer[7] << 8) | frame_buffer[8]);
                         }
                     }
                     reset_frame_parser();
@@ -279,25 +494,177 @@ static void process_DWIN_Frames(void)
         }
     }
     
-    if (g_frame_ready)
-    {
-        handle_DWIN_VP(g_frame_addr, g_frame_value);
-        g_frame_ready = 0;
-    }
+    /* Only the newest value per VP survives the drain */
+    dispatch_Pending_VPs();
 }
 
+/*===========================================================================*/
+/* DWIN VP Binding Table                                                      */
+/*===========================================================================*/
+/* Handler IDs: a dense switch compiles to a jump table and, unlike function
+   pointers in a table, keeps the C51 call tree (data overlay) intact */
+#define VP_H_NONE           0
+#define VP_H_POWER          1
+#define VP_H_LIGHT          2
+#define VP_H_MEMONE         3
+#define VP_H_MEMTWO         4
+#define VP_H_ENDO_MAX       5
+#define VP_H_PROFILE        6
+#define VP_H_CAM_SYNC       7
+#define VP_H_FAULT          8
+#define VP_H_SCR            9
+#define VP_H_TREND          10
+
+/* Descriptor flags */
+#define VP_POWERED          0x01    /* Ignored while the light is off */
+#define VP_CHANGED          0x02    /* Ignored if equal to the shadow */
+#define VP_CLAMP            0x04    /* Out of range: clamp instead of reject */
+
+#define VP_NONE             0xFF
+
+typedef struct
+{
+    uint16_t addr;
+    uint8_t data *shadow;   /* Updated before the handler runs, 0 = none */
+    uint8_t min;
+    uint8_t max;
+    uint8_t flags;
+    uint8_t handler;        /* VP_H_xxx */
+} VP_Desc_t;
+
+/* Sorted by address (binary search) */
+static VP_Desc_t code vp_table[] = {
+    { ADDR_POWER,       0,             0, 0xFF,                      0,                       VP_H_POWER    },
+    { ADDR_BRIGHT,      &g_brightness, 0, MAX_BRIGHTNESS,            VP_POWERED | VP_CHANGED, VP_H_LIGHT    },
+    { ADDR_CCT,         &g_cct,        0, MAX_CCT,                   VP_POWERED | VP_CHANGED, VP_H_LIGHT    },
+    { ADDR_MEMONE,      0,             1, DWIN_KEY_HOLD | 1,         VP_POWERED,              VP_H_MEMONE   },
+    { ADDR_MEMTWO,      0,             1, DWIN_KEY_HOLD | 1,         VP_POWERED,              VP_H_MEMTWO   },
+    { ADDR_ENDO_MAX,    0,             1, DWIN_KEY_HOLD | 2,         VP_POWERED,              VP_H_ENDO_MAX },
+    { ADDR_PWM_PROFILE, 0,             0, LED_PWM_PROFILE_COUNT - 1, 0,                       VP_H_PROFILE  },
+#if CAM_SYNC_ENABLE
+    { ADDR_CAM_SYNC,    0,             0, 0xFF,                      0,                       VP_H_CAM_SYNC },
+#endif
+#if FAULT_BRAKE_ENABLE
+    { ADDR_FAULT,       0,             0, 0xFF,                      0,                       VP_H_FAULT    },
+#endif
+    { ADDR_SCR,         &g_prev_scr,   0, 10,                        VP_CHANGED | VP_CLAMP,   VP_H_SCR      },
+#if TREND_ENABLE
+    { ADDR_TREND,       &g_trend,      0, 1,                         VP_CHANGED | VP_CLAMP,   VP_H_TREND    },
+#endif
+};
+
+#define VP_COUNT            (sizeof(vp_table) / sizeof(vp_table[0]))
+
+/* Latest-wins slots, one per table entry: vp_pending has 16 bits */
+typedef uint8_t vp_count_check_t[(VP_COUNT <= 16) ? 1 : -1];
+static uint16_t xdata vp_pending = 0;
+static uint16_t xdata vp_pending_value[VP_COUNT];
+
+/* Stale updates dropped: per entry (debugger) and total (ADDR_VP_SKIPPED) */
+static uint8_t xdata vp_skipped[VP_COUNT];
+static uint16_t xdata vp_skipped_total = 0;
+static uint16_t xdata vp_skipped_shown = 0;
+static uint16_t xdata vp_skipped_ms = 0;
+
 /*===========================================================================*/
 /* DWIN VP Handler                                                            */
 /*===========================================================================*/
-static void handle_DWIN_VP(uint16_t address, uint16_t value)
+/* Binary search: O(log n) compares whatever the table size */
+static uint8_t find_VP(uint16_t address)
+{
+    uint8_t lo = 0;
+    uint8_t hi = VP_COUNT;
+    uint8_t mid;
+    
+    while (lo < hi)
+    {
+        mid = (lo + hi) >> 1;
+        if (vp_table[mid].addr < address) lo = mid + 1;
+        else hi = mid;
+    }
+    
+    return (lo < VP_COUNT && vp_table[lo].addr == address) ? lo : VP_NONE;
+}
+
+/* Park a received value; a newer one for the same VP replaces it */
+static void queue_VP(uint16_t address, uint16_t value)
+{
+    uint8_t idx;
+    uint16_t bit_mask;
+    
+    /* Any upload from the panel is a touch */
+    wake_Backlight();
+    
+    idx = find_VP(address);
+    if (idx == VP_NONE) return;
+    
+    bit_mask = (uint16_t)1 << idx;
+    if (vp_pending & bit_mask)
+    {
+        if (vp_skipped[idx] != 0xFF) vp_skipped[idx]++;
+        vp_skipped_total++;
+    }
+    vp_pending |= bit_mask;
+    vp_pending_value[idx] = value;
+}
+
+/* Run each parked VP once, in table order */
+static void dispatch_Pending_VPs(void)
+{
+    uint8_t idx;
+    
+    for (idx = 0; vp_pending != 0; idx++)
+    {
+        if (!(vp_pending & ((uint16_t)1 << idx))) continue;
+        
+        vp_pending &= ~((uint16_t)1 << idx);
+        handle_DWIN_VP(idx, vp_pending_value[idx]);
+    }
+    
+    /* Skip counter to the display, at most once a second */
+    if (vp_skipped_total != vp_skipped_shown &&
+        (uint16_t)(timebase_ms() - vp_skipped_ms) >= VP_SKIPPED_REPORT_MS)
+    {
+        vp_skipped_shown = vp_skipped_total;
+        vp_skipped_ms = timebase_ms();
+        writeVP(ADDR_VP_SKIPPED, vp_skipped_shown);
+    }
+}
+
+/* Generic part: power gate, range check/clamp, shadow update */
+static void handle_DWIN_VP(uint8_t idx, uint16_t value)
 {
-    switch (address)
+    VP_Desc_t code *vp;
+    
+    vp = &vp_table[idx];
+    
+    if ((vp->flags & VP_POWERED) && !g_power) return;
+    
+    if (value < vp->min || value > vp->max)
+    {
+        if (!(vp->flags & VP_CLAMP)) return;
+        value = (value < vp->min) ? vp->min : vp->max;
+    }
+    
+    if (vp->shadow)
     {
-        case ADDR_POWER:
+        if ((vp->flags & VP_CHANGED) && *vp->shadow == (uint8_t)value) return;
+        *vp->shadow = (uint8_t)value;
+    }
+    
+    dispatch_VP(vp->handler, vp->addr, (uint8_t)value);
+}
+
+/* Side effects only; value is validated and shadowed already */
+static void dispatch_VP(uint8_t handler, uint16_t address, uint8_t value)
+{
+    switch (handler)
+    {
+        case VP_H_POWER:
             if (value && !g_power)
             {
                 g_power = 1;
-                g_brightness = 7;
+                g_brightness = 5;
                 g_cct = 3;
                 update_PWM();
                 sync_Display();
@@ -309,117 +676,295 @@ static void handle_DWIN_VP(uint16_t address, uint16_t value)
             }
             break;
             
-        case ADDR_BRIGHT:
-            if (g_power && value <= MAX_BRIGHTNESS && value != g_brightness)
-            {
-                g_brightness = (uint8_t)value;
-                update_PWM();
-            }
+        case VP_H_LIGHT:
+            update_PWM();
             break;
             
-        case ADDR_CCT:
-            if (g_power && value <= MAX_CCT && value != g_cct)
-            {
-                g_cct = (uint8_t)value;
-                update_PWM();
-            }
+        case VP_H_MEMONE:
+            if ((value & ~DWIN_KEY_HOLD) == 1) key_Preset(address, value, PRESET_MEM1);
             break;
             
-        case ADDR_MEMONE:
-            if (g_power && value == 1)
-            {
-                g_brightness = 6;
-                g_cct = 4;
-                update_PWM();
-                writeVP(ADDR_MEMONE, 0);
-                sync_Display();
-            }
+        case VP_H_MEMTWO:
+            if ((value & ~DWIN_KEY_HOLD) == 1) key_Preset(address, value, PRESET_MEM2);
             break;
             
-        case ADDR_MEMTWO:
-            if (g_power && value == 1)
-            {
-                g_brightness = 4;
-                g_cct = 7;
-                update_PWM();
-                writeVP(ADDR_MEMTWO, 0);
-                sync_Display();
-            }
+        case VP_H_ENDO_MAX:
+            /* 1 = Endo, 2 = Max */
+            if ((value & ~DWIN_KEY_HOLD) == 1) key_Preset(address, value, PRESET_ENDO);
+            else if ((value & ~DWIN_KEY_HOLD) == 2) key_Preset(address, value, PRESET_MAX);
             break;
             
-        case ADDR_ENDO_MAX:
-            if (g_power && value == 1)  /* Endo mode */
+        case VP_H_PROFILE:
+            if (value != led_pwm_get_profile())
             {
-                g_brightness = 1;
-                g_cct = 1;
-                update_PWM();
-                writeVP(ADDR_ENDO_MAX, 0);
-                sync_Display();
-            }
-            else if (g_power && value == 2)  /* Max mode */
-            {
-                g_brightness = MAX_BRIGHTNESS;
-                g_cct = MAX_CCT;
-                update_PWM();
-                writeVP(ADDR_ENDO_MAX, 0);
-                sync_Display();
+                apply_PWM_Profile(value);
             }
             break;
             
-        case ADDR_SCR:
-            if (value && value != g_prev_scr)
+#if CAM_SYNC_ENABLE
+        case VP_H_CAM_SYNC:
+            cam_sync_arm(value ? 1 : 0);
+            break;
+#endif
+            
+#if FAULT_BRAKE_ENABLE
+        case VP_H_FAULT:
+            if (value == FAULT_NONE)
             {
-                writeScr((uint8_t)(value * 10));
-                g_prev_scr = (uint8_t)value;
+                clear_Fault();
             }
-            else if (value == 0)
+            break;
+#endif
+            
+        case VP_H_SCR:
+            if (value)
             {
-                g_prev_scr = 0;
+                set_Backlight((uint8_t)(value * 10));
             }
             break;
+            
+#if TREND_ENABLE
+        case VP_H_TREND:
+            /* Start a fresh batch on the sample grid */
+            g_trend_count = 0;
+            g_trend_ms = timebase_ms();
+            break;
+#endif
+    }
+}
+
+/* Preset button: short press recalls, long press (| DWIN_KEY_HOLD) stores */
+static void key_Preset(uint16_t address, uint8_t key, uint8_t idx)
+{
+    if (key & DWIN_KEY_HOLD)
+    {
+        store_Preset(idx);
+    }
+    else
+    {
+        recall_Preset(idx);
+        sync_Display();
     }
+    writeVP(address, 0);
 }
 
 /*===========================================================================*/
 /* PWM Control Functions                                                      */
 /*===========================================================================*/
-static void set_White_Fast(uint8_t level)
+#if ADC_ISENSE_ENABLE || I2C_MODE == I2C_MODE_ALS
+/* duty x gain (Q12), limited to the profile full scale */
+static uint16_t scale_Duty(uint16_t duty, uint16_t gain)
 {
-    uint16_t pwm_val;
-    level = (level > MAX_BRIGHTNESS) ? MAX_BRIGHTNESS : level;
-    pwm_val = pwm_lut[level];
-    PWM1L = (uint8_t)(pwm_val);
-    PWM1H = (uint8_t)(pwm_val >> 8);
-    set_LOAD;
+    uint32_t scaled;
+    uint16_t full;
+
+    scaled = ((uint32_t)duty * gain) >> 12;
+    full = led_pwm_full_scale();
+    return (scaled > full) ? full : (uint16_t)scaled;
 }
+#endif
 
-static void set_Yellow_Fast(uint8_t level)
+/* Apply the current state with the default ramp for level changes */
+static void update_PWM(void)
 {
-    uint16_t pwm_val;
-    level = (level > MAX_CCT) ? MAX_CCT : level;
-    pwm_val = pwm_lut[level];
-    set_SFRPAGE;
-    PWM5L = (uint8_t)(pwm_val);
-    PWM5H = (uint8_t)(pwm_val >> 8);
-    clr_SFRPAGE;
-    set_LOAD;
+    fade_PWM(LED_FADE_STEP_MS);
 }
 
-static void update_PWM(void)
+/* Brightness sets total flux, CCT sets the White/Yellow split of it;
+   ramp_ms = 0 sets the output on the next tick (warm restart) */
+static void fade_PWM(uint16_t ramp_ms)
 {
-    if (g_power)
+    LED_Duty_t duty;
+    uint16_t intensity;
+    uint8_t level, cct, warm;
+    bit on;
+
+#if UART1_MODE == UART1_MODE_MODBUS || I2C_MODE == I2C_MODE_SLAVE
+    /* Inside a remote burst only the last request counts */
+    if (g_pwm_hold)
     {
-        set_White_Fast(g_brightness);
-        set_Yellow_Fast(g_cct);
+        g_pwm_held_ms = ramp_ms;
+        g_pwm_stale = 1;
+        return;
+    }
+#endif
+
+    on = g_power;
+#if UART1_MODE == UART1_MODE_DMX
+    if (g_dmx_live) on = 1;
+#endif
+
+    if (on)
+    {
+        level = (g_brightness > MAX_BRIGHTNESS) ? MAX_BRIGHTNESS : g_brightness;
+        cct = (g_cct > MAX_CCT) ? MAX_CCT : g_cct;
+        intensity = pwm_lut[level];
+        warm = cct_warm_lut[cct];
+#if UART1_MODE == UART1_MODE_DMX
+        if (g_dmx_live)
+        {
+            intensity = g_dmx_intensity;
+            warm = g_dmx_warm;
+        }
+#endif
+#if THERMAL_ENABLE
+        /* Heatsink derating scales total flux, CCT split is kept */
+        intensity = (uint16_t)(((uint32_t)intensity * thermal_limit()) >> 8);
+#endif
+        led_mix_compute(intensity, warm, &duty);
+#if ADC_ISENSE_ENABLE
+        /* On-current drift compensation, capped at 100% duty */
+        duty.white = scale_Duty(duty.white, current_loop_gain(ADC_ISENSE_WHITE));
+        duty.yellow = scale_Duty(duty.yellow, current_loop_gain(ADC_ISENSE_YELLOW));
+#endif
+#if I2C_MODE == I2C_MODE_ALS
+        /* Daylight harvesting trims White only */
+        duty.white = scale_Duty(duty.white, als_gain());
+#endif
     }
     else
     {
-        PWM1L = 0; PWM1H = 0;
-        set_SFRPAGE;
-        PWM5L = 0; PWM5H = 0;
-        clr_SFRPAGE;
-        set_LOAD;
+        duty.white = 0;
+        duty.yellow = 0;
+    }
+
+    /* Soft start/stop on power edges, Yellow staggered behind White */
+    if (on != g_lit)
+    {
+        g_lit = on;
+        led_fade_to(duty.white, duty.yellow, LED_FADE_POWER_MS,
+                    on ? LED_FADE_STAGGER_MS : 0);
+    }
+    else if (ramp_ms == 0)
+    {
+        led_fade_jump(duty.white, duty.yellow);
     }
+    else
+    {
+        led_fade_to(duty.white, duty.yellow, ramp_ms, 0);
+    }
+}
+
+/* O(1) preset recall: table entry straight into the fade engine */
+static void recall_Preset(uint8_t idx)
+{
+    Preset_t preset;
+    
+    if (!preset_get(idx, &preset)) return;
+    
+    g_brightness = preset.brightness;
+    g_cct = preset.cct;
+    fade_PWM(preset.fade_ms);
+}
+
+/* Store the current setting into a preset, double beep on success */
+static void store_Preset(uint8_t idx)
+{
+    if (!preset_store(idx, g_brightness, g_cct)) return;
+    
+    Beep();
+    Beep();
+}
+
+/* Switch PWM frequency/resolution and rescale the dimming LUT to it */
+static void apply_PWM_Profile(uint8_t profile)
+{
+    uint16_t full;
+    uint8_t i;
+    
+    /* Profile switch zeroes the outputs: stop the ramp, then restart from dark */
+    led_fade_reset();
+    led_pwm_profile(profile);
+    full = led_pwm_full_scale();
+    
+    for (i = 0; i <= MAX_BRIGHTNESS; i++)
+    {
+        pwm_lut[i] = (uint16_t)(((uint32_t)full * dim_permille[i]) / 1000);
+    }
+    
+    led_mix_init(full);
+    update_PWM();
+}
+
+#if FAULT_BRAKE_ENABLE
+/*===========================================================================*/
+/* Fault Handling                                                             */
+/*===========================================================================*/
+/* Brake already acted in hardware: report the latch to display and user */
+static void process_Fault(void)
+{
+    uint8_t fault;
+    
+    fault = fault_task();
+    if (fault == FAULT_NONE) return;
+    
+    writeVP(ADDR_FAULT, fault);
+    Beep();
+}
+
+/* Release the latch and relight through the soft-start ramp */
+static void clear_Fault(void)
+{
+    if (!fault_clear()) return;
+    
+    g_lit = 0;
+    apply_PWM_Profile(led_pwm_get_profile());
+    writeVP(ADDR_FAULT, FAULT_NONE);
+}
+#endif
+
+/*===========================================================================*/
+/* Persistent State                                                           */
+/*===========================================================================*/
+/* Load the last committed state; returns the PWM profile to start with */
+static uint8_t restore_State(void)
+{
+    State_t st;
+    
+    if (!state_store_init(&st)) return LED_PWM_PROFILE_DEFAULT;
+    
+    return load_State(&st);
+}
+
+/* Take a saved state into the globals; returns its PWM profile */
+static uint8_t load_State(State_t *st)
+{
+    g_power = st->power ? 1 : 0;
+    if (st->brightness <= MAX_BRIGHTNESS) g_brightness = st->brightness;
+    if (st->cct <= MAX_CCT) g_cct = st->cct;
+    
+    return (st->profile < LED_PWM_PROFILE_COUNT) ? st->profile : LED_PWM_PROFILE_DEFAULT;
+}
+
+/* Warm reset: the light was on a moment ago, relight without a ramp */
+static void restore_Warm(State_t *st)
+{
+    uint8_t profile;
+    
+    profile = load_State(st);
+    g_lit = g_power;
+    apply_PWM_Profile(profile);
+    fade_PWM(0);
+}
+
+static void get_State(State_t *st)
+{
+    st->power = g_power;
+    st->brightness = g_brightness;
+    st->cct = g_cct;
+    st->profile = led_pwm_get_profile();
+}
+
+/* Hand the live state to the write-back cache (flash commit is deferred) */
+static void save_State(void)
+{
+    State_t st;
+    
+    get_State(&st);
+    warm_state_save(&st);
+    state_store_set(&st);
+    /* A page erase stalls the CPU: not while a DWIN or IR frame arrives */
+    state_store_task(!rx_available() && frame_state == FRAME_IDLE && !is_ir_busy());
 }
 
 static void sync_Display(void)
@@ -428,55 +973,476 @@ static void sync_Display(void)
     writeVP(ADDR_CCT, g_cct);
 }
 
+/* Push the whole shadow state, one frame per VP in a single TX burst:
+   after boot (light already up) and whenever the panel comes back */
+static void process_Display_Sync(void)
+{
+    if (g_display_sync == DISPLAY_SYNC_DONE) return;
+    
+    if (g_display_sync == DISPLAY_SYNC_PENDING)
+    {
+        writeVP(ADDR_MEMONE, 0);
+        writeVP(ADDR_MEMTWO, 0);
+        writeVP(ADDR_ENDO_MAX, 0);
+        writeVP(ADDR_BRIGHT, g_brightness);
+        writeVP(ADDR_CCT, g_cct);
+        writeVP(ADDR_PWM_PROFILE, led_pwm_get_profile());
+        writeVP(ADDR_POWER, g_power);
+#if FAULT_BRAKE_ENABLE
+        writeVP(ADDR_FAULT, fault_code());
+#endif
+#if BOD_SAVE_ENABLE
+        writeVP(ADDR_BOD_COST, bod_save_armed() ? g_bod_cost : BOD_COST_UNARMED);
+#endif
+#if WATCHDOG_ENABLE
+        writeVP(ADDR_RESET_CAUSE, ((uint16_t)watchdog_reset_cause() << 8) | watchdog_missed_task());
+        writeVP(ADDR_WDT_MISSES, watchdog_miss_count());
+#endif
+#if TREND_ENABLE
+        writeVP(ADDR_TREND, g_trend);
+#endif
+        /* Unknown user level and not dimmed: keep the panel's own setting */
+        if (g_prev_scr || g_dimmed) writeScr(g_backlight);
+        if (g_power) setPage(1);
+        g_display_sync = DISPLAY_SYNC_SENDING;
+        return;
+    }
+    
+    /* Synced when the last frame has left the UART */
+    if (tx_busy) return;
+    
+    g_display_sync = DISPLAY_SYNC_DONE;
+#if BOOT_TRACE_ENABLE
+    boot_trace_synced();
+    writeVP(ADDR_BOOT_LIGHT, boot_trace_light_us());
+    writeVP(ADDR_BOOT_SYNC, boot_trace_sync_ms());
+#endif
+}
+
+#if UART1_MODE == UART1_MODE_LINK
+/*===========================================================================*/
+/* Controller Bus                                                             */
+/*===========================================================================*/
+/* Another controller changed the setting: take it over and show it */
+static void process_Bus_Link(void)
+{
+    State_t st;
+    uint8_t profile;
+    
+    get_State(&st);
+    if (!bus_link_task(&st)) return;
+    
+    profile = load_State(&st);
+    if (profile != led_pwm_get_profile()) apply_PWM_Profile(profile);
+    else update_PWM();
+    
+    writeVP(ADDR_POWER, g_power);
+    writeVP(ADDR_PWM_PROFILE, profile);
+    sync_Display();
+}
+#endif
+
+#if UART1_MODE == UART1_MODE_MODBUS
 /*===========================================================================*/
-/* DWIN Communication - TX Only                                               */
+/* Modbus RTU Slave                                                           */
+/*===========================================================================*/
+/* Registers mirror the live state; BMS writes take the panel's path */
+static void process_Modbus(void)
+{
+    uint8_t written, value;
+    
+    modbus_set(MB_REG_POWER, g_power);
+    modbus_set(MB_REG_BRIGHT, g_brightness);
+    modbus_set(MB_REG_CCT, g_cct);
+    modbus_set(MB_REG_PROFILE, led_pwm_get_profile());
+    modbus_set(MB_REG_RECALL, 0);
+    modbus_set(MB_REG_STORE, 0);
+#if FAULT_BRAKE_ENABLE
+    modbus_set(MB_REG_FAULT, fault_code());
+#endif
+    
+    written = modbus_task();
+    if (!written) return;
+    
+    /* Shadows first, then one output update for the whole burst.
+       Power first: switching on resets the levels written with it */
+    hold_PWM();
+    if (written & MB_BIT(MB_REG_POWER)) apply_Remote_VP(ADDR_POWER, modbus_get(MB_REG_POWER));
+    if (written & MB_BIT(MB_REG_PROFILE)) apply_Remote_VP(ADDR_PWM_PROFILE, modbus_get(MB_REG_PROFILE));
+    if (written & MB_BIT(MB_REG_BRIGHT)) apply_Remote_VP(ADDR_BRIGHT, modbus_get(MB_REG_BRIGHT));
+    if (written & MB_BIT(MB_REG_CCT)) apply_Remote_VP(ADDR_CCT, modbus_get(MB_REG_CCT));
+#if FAULT_BRAKE_ENABLE
+    if (written & MB_BIT(MB_REG_FAULT)) apply_Remote_VP(ADDR_FAULT, modbus_get(MB_REG_FAULT));
+#endif
+    
+    value = (uint8_t)modbus_get(MB_REG_RECALL);
+    if ((written & MB_BIT(MB_REG_RECALL)) && value && g_power) recall_Preset(value - 1);
+    value = (uint8_t)modbus_get(MB_REG_STORE);
+    if ((written & MB_BIT(MB_REG_STORE)) && value && g_power) store_Preset(value - 1);
+    release_PWM();
+    
+    writeVP(ADDR_POWER, g_power);
+    writeVP(ADDR_PWM_PROFILE, led_pwm_get_profile());
+    sync_Display();
+}
+#endif
+
+#if I2C_MODE == I2C_MODE_SLAVE
 /*===========================================================================*/
+/* I2C Slave (Host Board)                                                     */
+/*===========================================================================*/
+/* Snapshot of the live state for the host; a write burst is applied as
+   a whole, in the Modbus order, through the panel's path */
+static void process_I2C_Slave(void)
+{
+    uint16_t written;
+    uint8_t value;
+    
+    i2c_slave_set(I2CS_REG_POWER, g_power);
+    i2c_slave_set(I2CS_REG_BRIGHT, g_brightness);
+    i2c_slave_set(I2CS_REG_CCT, g_cct);
+    i2c_slave_set(I2CS_REG_PROFILE, led_pwm_get_profile());
+    i2c_slave_set(I2CS_REG_RECALL, 0);
+    i2c_slave_set(I2CS_REG_STORE, 0);
+    value = g_lit ? I2CS_STATUS_LIT : 0;
+    if (g_link_up) value |= I2CS_STATUS_DISPLAY;
+#if FAULT_BRAKE_ENABLE
+    i2c_slave_set(I2CS_REG_FAULT, fault_code());
+    if (fault_code() != FAULT_NONE) value |= I2CS_STATUS_FAULT;
+#else
+    i2c_slave_set(I2CS_REG_FAULT, 0);
+#endif
+#if THERMAL_ENABLE
+    if (thermal_limit() < THERMAL_LIMIT_FULL) value |= I2CS_STATUS_DERATED;
+    i2c_slave_set(I2CS_REG_TEMP, thermal_temp_c());
+#else
+    i2c_slave_set(I2CS_REG_TEMP, 0);
+#endif
+    i2c_slave_set(I2CS_REG_STATUS, value);
+#if WATCHDOG_ENABLE
+    i2c_slave_set(I2CS_REG_RESET, watchdog_reset_cause());
+    i2c_slave_set(I2CS_REG_WDT_MISSES, watchdog_miss_count());
+#else
+    i2c_slave_set(I2CS_REG_RESET, 0);
+    i2c_slave_set(I2CS_REG_WDT_MISSES, 0);
+#endif
+    i2c_slave_publish();
+    
+    written = i2c_slave_task();
+    if (!written) return;
+    
+    /* Shadows first, then one output update for the whole burst.
+       Power first: switching on resets the levels written with it */
+    hold_PWM();
+    if (written & I2CS_BIT(I2CS_REG_POWER)) apply_Remote_VP(ADDR_POWER, i2c_slave_get(I2CS_REG_POWER));
+    if (written & I2CS_BIT(I2CS_REG_PROFILE)) apply_Remote_VP(ADDR_PWM_PROFILE, i2c_slave_get(I2CS_REG_PROFILE));
+    if (written & I2CS_BIT(I2CS_REG_BRIGHT)) apply_Remote_VP(ADDR_BRIGHT, i2c_slave_get(I2CS_REG_BRIGHT));
+    if (written & I2CS_BIT(I2CS_REG_CCT)) apply_Remote_VP(ADDR_CCT, i2c_slave_get(I2CS_REG_CCT));
+#if FAULT_BRAKE_ENABLE
+    if (written & I2CS_BIT(I2CS_REG_FAULT)) apply_Remote_VP(ADDR_FAULT, i2c_slave_get(I2CS_REG_FAULT));
+#endif
+    
+    value = i2c_slave_get(I2CS_REG_RECALL);
+    if ((written & I2CS_BIT(I2CS_REG_RECALL)) && value && g_power) recall_Preset(value - 1);
+    value = i2c_slave_get(I2CS_REG_STORE);
+    if ((written & I2CS_BIT(I2CS_REG_STORE)) && value && g_power) store_Preset(value - 1);
+    release_PWM();
+    
+    writeVP(ADDR_POWER, g_power);
+    writeVP(ADDR_PWM_PROFILE, led_pwm_get_profile());
+    sync_Display();
+}
+#endif
+
+#if UART1_MODE == UART1_MODE_MODBUS || I2C_MODE == I2C_MODE_SLAVE
+/* Same validation, shadow and side effects as an upload from the panel */
+static void apply_Remote_VP(uint16_t address, uint16_t value)
+{
+    uint8_t idx;
+    
+    idx = find_VP(address);
+    if (idx != VP_NONE) handle_DWIN_VP(idx, value);
+}
+
+/* Collect the output updates of a remote write burst ... */
+static void hold_PWM(void)
+{
+    g_pwm_hold = 1;
+    g_pwm_stale = 0;
+}
+
+/* ... and apply the final state once, with the last ramp requested */
+static void release_PWM(void)
+{
+    g_pwm_hold = 0;
+    if (g_pwm_stale) fade_PWM(g_pwm_held_ms);
+}
+#endif
+
+#if UART1_MODE == UART1_MODE_DMX
+/*===========================================================================*/
+/* DMX512 Receiver                                                            */
+/*===========================================================================*/
+/* Each packet (44 Hz) re-plans a ramp to its levels from wherever the
+   output is, so the output trails the console by at most one packet and
+   keeps the slew limit; the local state is kept and takes over again when
+   the signal is lost */
+static void process_DMX(void)
+{
+    uint8_t levels[DMX_CHANNELS];
+    uint8_t result;
+    
+    result = dmx_task(levels);
+    if (result == DMX_NONE) return;
+    
+    if (result == DMX_LOST)
+    {
+        g_dmx_live = 0;
+        update_PWM();
+        return;
+    }
+    
+    g_dmx_intensity = (uint16_t)(((uint32_t)pwm_lut[MAX_BRIGHTNESS] * levels[DMX_CH_INTENSITY]) / 255);
+    g_dmx_warm = (uint8_t)(((uint16_t)levels[DMX_CH_CCT] * 128 + 127) / 255);
+    g_dmx_live = 1;
+    fade_PWM(DMX_RAMP_MS);
+}
+#endif
+
+/*===========================================================================*/
+/* DWIN Link Supervision                                                      */
+/*===========================================================================*/
+/* Ping the panel while idle; missed replies mark it gone */
+static void process_DWIN_Link(void)
+{
+    uint16_t now;
+    
+    if (g_display_sync != DISPLAY_SYNC_DONE) return;
+    
+    now = timebase_ms();
+    
+    if (g_ping_wait)
+    {
+        if ((uint16_t)(now - g_ping_ms) < DWIN_PING_TIMEOUT_MS) return;
+        
+        g_ping_wait = 0;
+        if (g_ping_misses < DWIN_LINK_MISSES && ++g_ping_misses == DWIN_LINK_MISSES)
+        {
+            g_link_up = 0;
+        }
+    }
+    
+    if ((uint16_t)(now - g_ping_ms) < DWIN_PING_MS) return;
+    
+    readVP(DWIN_PING_VP, 1);
+    g_ping_ms = now;
+    g_ping_wait = 1;
+}
+
+/* Any complete frame proves the link; after an outage resync everything */
+static void link_Alive(void)
+{
+    g_ping_wait = 0;
+    g_ping_misses = 0;
+    
+    if (!g_link_up)
+    {
+        g_link_up = 1;
+        g_display_sync = DISPLAY_SYNC_PENDING;
+    }
+}
+
+/*===========================================================================*/
+/* DWIN Communication                                                         */
+/*===========================================================================*/
+static void readVP(uint16_t address, uint8_t words)
+{
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(0x04);
+    tx_write(DWIN_CMD_READ_RESP);
+    tx_write((uint8_t)(address >> 8));
+    tx_write((uint8_t)(address));
+    tx_write(words);
+}
+
 static void writeVP(uint16_t address, uint16_t value)
 {
-    Send_Data_To_UART0(0x5A);
-    Send_Data_To_UART0(0xA5);
-    Send_Data_To_UART0(0x05);
-    Send_Data_To_UART0(0x82);
-    Send_Data_To_UART0((uint8_t)(address >> 8));
-    Send_Data_To_UART0((uint8_t)(address));
-    Send_Data_To_UART0((uint8_t)(value >> 8));
-    Send_Data_To_UART0((uint8_t)(value));
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(0x05);
+    tx_write(0x82);
+    tx_write((uint8_t)(address >> 8));
+    tx_write((uint8_t)(address));
+    tx_write((uint8_t)(value >> 8));
+    tx_write((uint8_t)(value));
 }
 
 static void setPage(uint8_t page)
 {
-    Send_Data_To_UART0(0x5A);
-    Send_Data_To_UART0(0xA5);
-    Send_Data_To_UART0(0x07);
-    Send_Data_To_UART0(0x82);
-    Send_Data_To_UART0(0x00);
-    Send_Data_To_UART0(0x84);
-    Send_Data_To_UART0(0x5A);
-    Send_Data_To_UART0(0x01);
-    Send_Data_To_UART0(0x00);
-    Send_Data_To_UART0(page);
-    Timer3_Delay10us(500);
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(0x07);
+    tx_write(0x82);
+    tx_write(0x00);
+    tx_write(0x84);
+    tx_write(0x5A);
+    tx_write(0x01);
+    tx_write(0x00);
+    tx_write(page);
 }
 
 static void writeScr(uint8_t value)
 {
-    Send_Data_To_UART0(0x5A);
-    Send_Data_To_UART0(0xA5);
-    Send_Data_To_UART0(0x04);
-    Send_Data_To_UART0(0x82);
-    Send_Data_To_UART0(0x00);
-    Send_Data_To_UART0(0x82);
-    Send_Data_To_UART0(value);
-    Timer3_Delay10us(10000);
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(0x04);
+    tx_write(0x82);
+    tx_write(0x00);
+    tx_write(0x82);
+    tx_write(value);
+}
+
+#if TREND_ENABLE
+/*===========================================================================*/
+/* DWIN Trend Streaming                                                       */
+/*===========================================================================*/
+static uint16_t duty_Permille(uint16_t counts, uint16_t full)
+{
+    if (full == 0) return 0;
+    return (uint16_t)(((uint32_t)counts * 1000) / full);
+}
+
+/* Sample on a fixed grid; a full batch goes out only on an idle TX path */
+static void process_Trend(void)
+{
+    uint16_t full, white, yellow;
+    
+    if (!g_trend) return;
+    if ((uint16_t)(timebase_ms() - g_trend_ms) < TREND_SAMPLE_MS) return;
+    g_trend_ms += TREND_SAMPLE_MS;
+    
+    full = led_pwm_full_scale() >> LED_DUTY_FRAC_BITS;
+    led_pwm_counts(&white, &yellow);
+    trend_buf[TREND_CH_WHITE][g_trend_count] = duty_Permille(white, full);
+    trend_buf[TREND_CH_YELLOW][g_trend_count] = duty_Permille(yellow, full);
+#if THERMAL_ENABLE
+    trend_buf[TREND_CH_TEMP][g_trend_count] = thermal_temp_c();
+#endif
+    
+    if (++g_trend_count < TREND_BATCH) return;
+    g_trend_count = 0;
+    
+    /* Control frames first: skip the batch rather than queue behind them */
+    if (tx_busy || g_display_sync != DISPLAY_SYNC_DONE)
+    {
+        g_trend_dropped++;
+        return;
+    }
+    send_Trend();
+}
+
+/* One 0x0310 write: 5A A5, block count, 00, then per channel ID, n, n words */
+static void send_Trend(void)
+{
+    uint8_t ch, i;
+    
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(3 + 4 + TREND_CHANNELS * (2 + 2 * TREND_BATCH));
+    tx_write(0x82);
+    tx_write((uint8_t)(ADDR_CURVE_BUF >> 8));
+    tx_write((uint8_t)(ADDR_CURVE_BUF));
+    tx_write(0x5A);
+    tx_write(0xA5);
+    tx_write(TREND_CHANNELS);
+    tx_write(0x00);
+    
+    for (ch = 0; ch < TREND_CHANNELS; ch++)
+    {
+        tx_write(ch);
+        tx_write(TREND_BATCH);
+        for (i = 0; i < TREND_BATCH; i++)
+        {
+            tx_write((uint8_t)(trend_buf[ch][i] >> 8));
+            tx_write((uint8_t)(trend_buf[ch][i]));
+        }
+    }
+}
+#endif
+
+/*===========================================================================*/
+/* Backlight Auto-Dim                                                         */
+/*===========================================================================*/
+static void set_Backlight(uint8_t pct)
+{
+    if (pct == g_backlight) return;
+    
+    g_backlight = pct;
+    writeScr(pct);
+}
+
+/* Touch or IR input: restart the idle timer, undo any dimming */
+static void wake_Backlight(void)
+{
+    g_idle_steps = 0;
+    
+    /* Only write the panel when the level is known or was dimmed by us */
+    if (g_prev_scr) set_Backlight((uint8_t)(g_prev_scr * 10));
+    else if (g_dimmed) set_Backlight(BACKLIGHT_FULL_PCT);
+    g_dimmed = 0;
+}
+
+static void process_Backlight(void)
+{
+    uint8_t pct;
+    
+    if ((uint16_t)(timebase_ms() - g_idle_tick_ms) < BACKLIGHT_STEP_MS) return;
+    g_idle_tick_ms += BACKLIGHT_STEP_MS;
+    
+    if (g_idle_steps < 0xFFFF) g_idle_steps++;
+    if (g_idle_steps < (uint16_t)BACKLIGHT_IDLE_MIN * 60 * (1000 / BACKLIGHT_STEP_MS)) return;
+    if (g_backlight <= BACKLIGHT_DIM_PCT) return;
+    
+    pct = g_backlight - BACKLIGHT_STEP_PCT;
+    g_dimmed = 1;
+    set_Backlight((pct < BACKLIGHT_DIM_PCT) ? BACKLIGHT_DIM_PCT : pct);
 }
 
 /*===========================================================================*/
 /* IR Command Processing                                                      */
 /*===========================================================================*/
+/* Pending preset key: repeats count towards a store, silence = short press */
+static void process_IR_Hold(void)
+{
+    if (ir_hold_preset == IR_HOLD_NONE) return;
+    
+    if (is_ir_repeat())
+    {
+        ir_hold_ms = timebase_ms();
+        if (++ir_hold_repeats >= IR_HOLD_REPEATS)
+        {
+            store_Preset(ir_hold_preset);
+            ir_hold_preset = IR_HOLD_NONE;
+        }
+    }
+    else if ((uint16_t)(timebase_ms() - ir_hold_ms) > IR_RELEASE_MS)
+    {
+        if (g_power)
+        {
+            recall_Preset(ir_hold_preset);
+            sync_Display();
+        }
+        ir_hold_preset = IR_HOLD_NONE;
+    }
+}
+
 static void process_IR(void)
 {
     uint8_t cmd, inv;
     
+    process_IR_Hold();
+    
     if (!is_ir_data_received()) return;
     
     get_ir_data(ir_data, IR_DATA_LEN);
@@ -486,6 +1452,31 @@ static void process_IR(void)
     
     if ((cmd ^ inv) != 0xFF) return;
     
+    wake_Backlight();
+    
+    /* A new key ends a pending preset press as a short press */
+    if (ir_hold_preset != IR_HOLD_NONE)
+    {
+        if (g_power) recall_Preset(ir_hold_preset);
+        ir_hold_preset = IR_HOLD_NONE;
+    }
+    
+#if FAULT_BRAKE_ENABLE
+    /* Braked: Power key acknowledges and relights, other keys are refused */
+    if (fault_code() != FAULT_NONE)
+    {
+        if (cmd == IR_CMD_POWER)
+        {
+            clear_Fault();
+        }
+        else
+        {
+            Beep();
+        }
+        return;
+    }
+#endif
+    
     if (cmd == IR_CMD_POWER)
     {
         g_power = !g_power;
@@ -493,7 +1484,7 @@ static void process_IR(void)
         {
             setPage(1);
             writeVP(ADDR_POWER, 1);
-            g_brightness = 7;
+            g_brightness = 5;
             g_cct = 3;
         }
         else
@@ -532,36 +1523,16 @@ static void process_IR(void)
         update_PWM();
         sync_Display();
     }
-    else if (cmd == IR_CMD_ENDO)
+    else if (cmd == IR_CMD_ENDO || cmd == IR_CMD_MEM1 ||
+             cmd == IR_CMD_MAX || cmd == IR_CMD_MEM2)
     {
-        g_brightness = 1;
-        g_cct = 1;
-        update_PWM();
-        sync_Display();
-    }
-    else if (cmd == IR_CMD_MEM1)
-    {
-        g_brightness = 6;
-        g_cct = 4;
-        update_PWM();
-        sync_Display();
-    }
-    else if (cmd == IR_CMD_MAX)
-    {
-        g_brightness = MAX_BRIGHTNESS;
-        g_cct = MAX_CCT;
-        update_PWM();
-        sync_Display();
-    }
-    else if (cmd == IR_CMD_MEM2)
-    {
-        g_brightness = 4;
-        g_cct = 7;
-        update_PWM();
-        sync_Display();
+        /* Acted on at release (recall) or after the hold time (store) */
+        ir_hold_preset = (cmd == IR_CMD_ENDO) ? PRESET_ENDO :
+                         (cmd == IR_CMD_MEM1) ? PRESET_MEM1 :
+                         (cmd == IR_CMD_MEM2) ? PRESET_MEM2 : PRESET_MAX;
+        ir_hold_repeats = 0;
+        ir_hold_ms = timebase_ms();
     }
-    
-    Timer3_Delay10us(100);
 }
 
 /*===========================================================================*/
@@ -607,6 +1578,7 @@ static void MODIFY_HIRC_24576(void)
         TA = 0xAA;
         TA = 0x55;
         RCTRIM1 = hircmap1;
+        u32SysClock = 24576000UL;
         
         PCON &= CLR_BIT4;
     }
@@ -614,35 +1586,38 @@ static void MODIFY_HIRC_24576(void)
 
 static void UART_Init(void)
 {
-    MODIFY_HIRC_24576();
     InitialUART0_Timer1(115200);
     
     ENABLE_UART0_INTERRUPT;   /* Enable Serial interrupt */
     ENABLE_GLOBAL_INTERRUPT;   /* Enable global interrupts */
 }
 
-static void PWM_Init(void)
+/* Queue a beep; process_Beep() sounds it without blocking */
+static void Beep(void)
 {
-    PWM1_P14_OUTPUT_ENABLE;
-    PWM5_P15_OUTPUT_ENABLE;
-    PWM_IMDEPENDENT_MODE;
-    PWM_EDGE_TYPE;
-    set_CLRPWM;
-    PWM_CLOCK_FSYS;
-    PWM_CLOCK_DIV_8;
-    PWM_OUTPUT_ALL_NORMAL;
-    
-    PWMPL = (uint8_t)(PWM_PERIOD);
-    PWMPH = (uint8_t)(PWM_PERIOD >> 8);
-    
-    set_PWMRUN;
+    if (g_beeps < 4) g_beeps++;
 }
 
-static void Beep(void)
+static void process_Beep(void)
 {
-    BuzzerPin = 1;
-    Timer3_Delay10us(200);
-    BuzzerPin = 0;
+    uint16_t elapsed;
+    
+    elapsed = (uint16_t)(timebase_ms() - g_beep_ms);
+    
+    if (BuzzerPin)
+    {
+        if (elapsed > BEEP_ON_MS)
+        {
+            BuzzerPin = 0;
+            g_beep_ms = timebase_ms();
+        }
+    }
+    else if (g_beeps && elapsed > BEEP_GAP_MS)
+    {
+        BuzzerPin = 1;
+        g_beeps--;
+        g_beep_ms = timebase_ms();
+    }
 }
 
 /*===========================================================================*/
@@ -650,19 +1625,116 @@ static void Beep(void)
 /*===========================================================================*/
 void main(void)
 {
+    State_t st;
+    uint8_t warm;
+    
     GPIO_Init();
-    Beep();
+    timebase_init();
+    warm = warm_state_load(&st);
+#if WATCHDOG_ENABLE
+    watchdog_init();
+#endif
+    MODIFY_HIRC_24576();
+    led_pwm_init();
+    led_fade_init();
+#if ADC_ISENSE_ENABLE
+    current_loop_init();
+#endif
+    
+    /* Light first: restored state straight into the PWM stage */
+    if (warm) restore_Warm(&st);
+    else apply_PWM_Profile(restore_State());
+    ENABLE_GLOBAL_INTERRUPT;
+    
+    /* The log scan is always needed; a warm image is newer than the log */
+    if (warm) state_store_init(&st);
+    
     UART_Init();
-    PWM_Init();
+    preset_init();
+#if UART1_MODE == UART1_MODE_LINK
+    bus_link_init();
+#endif
+#if UART1_MODE == UART1_MODE_MODBUS
+    modbus_init();
+#endif
+#if UART1_MODE == UART1_MODE_DMX
+    dmx_init();
+#endif
+#if I2C_MODE == I2C_MODE_ALS
+    als_init();
+#endif
+#if I2C_MODE == I2C_MODE_SLAVE
+    i2c_slave_init();
+#endif
     
-    writeVP(ADDR_MEMONE, 0);
-    writeVP(ADDR_MEMTWO, 0);
-    writeVP(ADDR_ENDO_MAX, 0);
+#if CAM_SYNC_ENABLE
+    cam_sync_init();
+#endif
+#if THERMAL_ENABLE
+    thermal_init();
+#endif
+#if FAULT_BRAKE_ENABLE
+    fault_init();
+#endif
+#if THERMAL_ENABLE || ADC_ISENSE_ENABLE
+    adc_sense_init();
+#endif
+#if BOD_SAVE_ENABLE
+    g_bod_cost = bod_save_init();
+#endif
     
-    update_PWM();
+    /* Beep and display sync run from the loop */
+    if (!warm) Beep();
+    
+#if WATCHDOG_ENABLE
+    watchdog_start();
+#endif
     
     while (1)
     {
-        process_IR();        process_DWIN_Frames();
+        process_IR();
+#if UART1_MODE == UART1_MODE_DMX
+        process_DMX();
+#endif
+        WATCHDOG_CHECKIN(WDT_TASK_IR);
+        process_DWIN_Frames();
+        process_Display_Sync();
+        process_DWIN_Link();
+#if UART1_MODE == UART1_MODE_LINK
+        process_Bus_Link();
+#endif
+#if UART1_MODE == UART1_MODE_MODBUS
+        process_Modbus();
+#endif
+#if I2C_MODE == I2C_MODE_SLAVE
+        process_I2C_Slave();
+#endif
+        process_Backlight();
+#if TREND_ENABLE
+        process_Trend();
+#endif
+        process_Beep();
+        WATCHDOG_CHECKIN(WDT_TASK_DWIN);
+        save_State();
+#if BOD_SAVE_ENABLE
+        if (bod_save_task()) writeVP(ADDR_BOD_COST, g_bod_cost);
+#endif
+        WATCHDOG_CHECKIN(WDT_TASK_STATE);
+#if CAM_SYNC_ENABLE
+        cam_sync_task();
+#endif
+#if THERMAL_ENABLE
+        if (thermal_task() && g_lit) update_PWM();
+#endif
+#if ADC_ISENSE_ENABLE
+        if (current_loop_task() && g_lit) update_PWM();
+#endif
+#if I2C_MODE == I2C_MODE_ALS
+        if (als_task() && g_lit) update_PWM();
+#endif
+#if FAULT_BRAKE_ENABLE
+        process_Fault();
+#endif
+        WATCHDOG_CHECKIN(WDT_TASK_SENSE);
     }
 }   
\ No newline at end of file
@@ -0,0 +1,289 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     modbus.c
+ * @brief    Modbus RTU slave on UART1 (RS-485) for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Lets a building management system poll and set the light.
+ *           uart1.c receives in the background; a frame ends when the
+ *           line has been idle for t3.5, measured by the Timer2 timebase
+ *           tick (uart1_rx_idle_ms()). The request is then handled in one
+ *           main loop pass and the reply queued on the TX ring, so IR and
+ *           DWIN handling never wait on the bus.
+ *
+ * Frame:  [addr][function][data...][CRC lo][CRC hi]
+ *   - 03 Read Holding Registers, 06 Write Single, 16 Write Multiple
+ *   - Broadcast (address 0): writes only, no reply
+ *   - Exceptions: 01 function, 02 address, 03 value / malformed
+ *   - A multiple write is validated as a whole before anything is stored
+ *   - CRC-16 (poly 0xA001, init 0xFFFF) from two 256 byte tables in code
+ ******************************************************************************/
+
+#include "modbus.h"
+#include "led_pwm.h"
+#include "preset.h"
+
+#if UART1_MODE == UART1_MODE_MODBUS
+
+#define MB_FC_READ_HOLDING      0x03
+#define MB_FC_WRITE_SINGLE      0x06
+#define MB_FC_WRITE_MULTIPLE    0x10
+
+#define MB_EX_FUNCTION          0x01
+#define MB_EX_ADDRESS           0x02
+#define MB_EX_VALUE             0x03
+
+#define MB_FRAME_MAX            UART1_RX_SIZE
+
+/*===========================================================================*/
+/* CRC-16 Tables                                                              */
+/*===========================================================================*/
+static uint8_t code s_crc_hi[256] = {
+    0x00, 0xC0, 0xC1, 0x01, 0xC3, 0x03, 0x02, 0xC2, 0xC6, 0x06, 0x07, 0xC7,
+    0x05, 0xC5, 0xC4, 0x04, 0xCC, 0x0C, 0x0D, 0xCD, 0x0F, 0xCF, 0xCE, 0x0E,
+    0x0A, 0xCA, 0xCB, 0x0B, 0xC9, 0x09, 0x08, 0xC8, 0xD8, 0x18, 0x19, 0xD9,
+    0x1B, 0xDB, 0xDA, 0x1A, 0x1E, 0xDE, 0xDF, 0x1F, 0xDD, 0x1D, 0x1C, 0xDC,
+    0x14, 0xD4, 0xD5, 0x15, 0xD7, 0x17, 0x16, 0xD6, 0xD2, 0x12, 0x13, 0xD3,
+    0x11, 0xD1, 0xD0, 0x10, 0xF0, 0x30, 0x31, 0xF1, 0x33, 0xF3, 0xF2, 0x32,
+    0x36, 0xF6, 0xF7, 0x37, 0xF5, 0x35, 0x34, 0xF4, 0x3C, 0xFC, 0xFD, 0x3D,
+    0xFF, 0x3F, 0x3E, 0xFE, 0xFA, 0x3A, 0x3B, 0xFB, 0x39, 0xF9, 0xF8, 0x38,
+    0x28, 0xE8, 0xE9, 0x29, 0xEB, 0x2B, 0x2A, 0xEA, 0xEE, 0x2E, 0x2F, 0xEF,
+    0x2D, 0xED, 0xEC, 0x2C, 0xE4, 0x24, 0x25, 0xE5, 0x27, 0xE7, 0xE6, 0x26,
+    0x22, 0xE2, 0xE3, 0x23, 0xE1, 0x21, 0x20, 0xE0, 0xA0, 0x60, 0x61, 0xA1,
+    0x63, 0xA3, 0xA2, 0x62, 0x66, 0xA6, 0xA7, 0x67, 0xA5, 0x65, 0x64, 0xA4,
+    0x6C, 0xAC, 0xAD, 0x6D, 0xAF, 0x6F, 0x6E, 0xAE, 0xAA, 0x6A, 0x6B, 0xAB,
+    0x69, 0xA9, 0xA8, 0x68, 0x78, 0xB8, 0xB9, 0x79, 0xBB, 0x7B, 0x7A, 0xBA,
+    0xBE, 0x7E, 0x7F, 0xBF, 0x7D, 0xBD, 0xBC, 0x7C, 0xB4, 0x74, 0x75, 0xB5,
+    0x77, 0xB7, 0xB6, 0x76, 0x72, 0xB2, 0xB3, 0x73, 0xB1, 0x71, 0x70, 0xB0,
+    0x50, 0x90, 0x91, 0x51, 0x93, 0x53, 0x52, 0x92, 0x96, 0x56, 0x57, 0x97,
+    0x55, 0x95, 0x94, 0x54, 0x9C, 0x5C, 0x5D, 0x9D, 0x5F, 0x9F, 0x9E, 0x5E,
+    0x5A, 0x9A, 0x9B, 0x5B, 0x99, 0x59, 0x58, 0x98, 0x88, 0x48, 0x49, 0x89,
+    0x4B, 0x8B, 0x8A, 0x4A, 0x4E, 0x8E, 0x8F, 0x4F, 0x8D, 0x4D, 0x4C, 0x8C,
+    0x44, 0x84, 0x85, 0x45, 0x87, 0x47, 0x46, 0x86, 0x82, 0x42, 0x43, 0x83,
+    0x41, 0x81, 0x80, 0x40
+};
+
+static uint8_t code s_crc_lo[256] = {
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41,
+    0x00, 0xC1, 0x81, 0x40
+};
+
+/* Highest value accepted per register */
+static uint16_t code s_reg_max[MB_REG_COUNT] = {
+    1, MB_LEVEL_MAX, MB_LEVEL_MAX, LED_PWM_PROFILE_COUNT - 1,
+    PRESET_COUNT, PRESET_COUNT, 0
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static uint8_t xdata s_frame[MB_FRAME_MAX];
+static uint16_t xdata s_regs[MB_REG_COUNT];
+static uint8_t xdata s_written;         /* MB_BIT() mask of the current request */
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* CRC of len bytes, low byte first on the wire */
+static uint16_t crc16(uint8_t len)
+{
+    uint8_t hi, lo, idx, i;
+
+    hi = 0xFF;
+    lo = 0xFF;
+    for (i = 0; i < len; i++)
+    {
+        idx = lo ^ s_frame[i];
+        lo = hi ^ s_crc_lo[idx];
+        hi = s_crc_hi[idx];
+    }
+
+    return ((uint16_t)hi << 8) | lo;
+}
+
+static void send_reply(uint8_t len)
+{
+    uint16_t crc;
+
+    if (s_frame[0] == MODBUS_BROADCAST) return;
+
+    crc = crc16(len);
+    s_frame[len] = (uint8_t)crc;
+    s_frame[len + 1] = (uint8_t)(crc >> 8);
+    uart1_write(s_frame, len + 2);
+}
+
+static void send_exception(uint8_t code_ex)
+{
+    s_frame[1] |= 0x80;
+    s_frame[2] = code_ex;
+    send_reply(3);
+}
+
+#define FRAME_WORD(i)   (((uint16_t)s_frame[i] << 8) | s_frame[(i) + 1])
+
+/*===========================================================================*/
+/* Function Handlers - return an exception code, 0 = replied                  */
+/*===========================================================================*/
+static uint8_t read_holding(uint8_t len)
+{
+    uint16_t start, qty;
+    uint8_t i;
+
+    if (len != 6) return MB_EX_VALUE;
+
+    start = FRAME_WORD(2);
+    qty = FRAME_WORD(4);
+    if (qty == 0 || qty > MB_REG_COUNT) return MB_EX_VALUE;
+    if (start >= MB_REG_COUNT || start + qty > MB_REG_COUNT) return MB_EX_ADDRESS;
+
+    s_frame[2] = (uint8_t)(qty << 1);
+    for (i = 0; i < (uint8_t)qty; i++)
+    {
+        s_frame[3 + (i << 1)] = (uint8_t)(s_regs[start + i] >> 8);
+        s_frame[4 + (i << 1)] = (uint8_t)s_regs[start + i];
+    }
+    send_reply(3 + (uint8_t)(qty << 1));
+
+    return 0;
+}
+
+static uint8_t write_single(uint8_t len)
+{
+    uint16_t reg, value;
+
+    if (len != 6) return MB_EX_VALUE;
+
+    reg = FRAME_WORD(2);
+    value = FRAME_WORD(4);
+    if (reg >= MB_REG_COUNT) return MB_EX_ADDRESS;
+    if (value > s_reg_max[reg]) return MB_EX_VALUE;
+
+    s_regs[reg] = value;
+    s_written = MB_BIT(reg);
+    send_reply(6);                  /* Echo of the request */
+
+    return 0;
+}
+
+static uint8_t write_multiple(uint8_t len)
+{
+    uint16_t start, qty;
+    uint8_t i;
+
+    if (len < 7) return MB_EX_VALUE;
+
+    start = FRAME_WORD(2);
+    qty = FRAME_WORD(4);
+    if (qty == 0 || qty > MB_REG_COUNT) return MB_EX_VALUE;
+    if (s_frame[6] != (uint8_t)(qty << 1) || len != 7 + s_frame[6]) return MB_EX_VALUE;
+    if (start >= MB_REG_COUNT || start + qty > MB_REG_COUNT) return MB_EX_ADDRESS;
+
+    /* All or nothing */
+    for (i = 0; i < (uint8_t)qty; i++)
+    {
+        if (FRAME_WORD(7 + (i << 1)) > s_reg_max[start + i]) return MB_EX_VALUE;
+    }
+
+    for (i = 0; i < (uint8_t)qty; i++)
+    {
+        s_regs[start + i] = FRAME_WORD(7 + (i << 1));
+        s_written |= MB_BIT(start + i);
+    }
+    send_reply(6);                  /* Address + quantity */
+
+    return 0;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void modbus_init(void)
+{
+    uart1_init(MODBUS_BAUD, MODBUS_PARITY);
+}
+
+void modbus_set(uint8_t reg, uint16_t value)
+{
+    s_regs[reg] = value;
+}
+
+uint16_t modbus_get(uint8_t reg)
+{
+    return s_regs[reg];
+}
+
+uint8_t modbus_task(void)
+{
+    uint16_t crc;
+    uint8_t len, ex;
+
+    if (!uart1_available()) return 0;
+    if (uart1_rx_idle_ms() < MODBUS_T35_TICKS) return 0;
+
+    len = 0;
+    while (uart1_available())
+    {
+        s_frame[len++] = uart1_read();
+    }
+
+    /* Corrupt, short, foreign or bad CRC: drop silently */
+    if (uart1_rx_error() || len < 4) return 0;
+    if (s_frame[0] != MODBUS_ADDR && s_frame[0] != MODBUS_BROADCAST) return 0;
+
+    len -= 2;
+    crc = crc16(len);
+    if (s_frame[len] != (uint8_t)crc || s_frame[len + 1] != (uint8_t)(crc >> 8)) return 0;
+
+    s_written = 0;
+    switch (s_frame[1])
+    {
+        case MB_FC_READ_HOLDING:
+            /* Nobody answers a broadcast read */
+            ex = (s_frame[0] == MODBUS_BROADCAST) ? 0 : read_holding(len);
+            break;
+
+        case MB_FC_WRITE_SINGLE:
+            ex = write_single(len);
+            break;
+
+        case MB_FC_WRITE_MULTIPLE:
+            ex = write_multiple(len);
+            break;
+
+        default:
+            ex = MB_EX_FUNCTION;
+            break;
+    }
+
+    if (ex) send_exception(ex);
+
+    return s_written;
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     preset.c
+ * @brief    Lighting presets for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Presets are data, not code: recall is one indexed copy from a
+ *           RAM table. The table starts from the factory values in code
+ *           memory and is replaced by the flash page copy when that page
+ *           holds a valid image (magic + checksum).
+ *
+ * Flash Page Image (FLASH_PRESET_PAGE):
+ *   [0] magic  [1] count  [2..] Preset_t x count  [n] checksum (sum = 0)
+ ******************************************************************************/
+
+#include "preset.h"
+#include "flash_iap.h"
+
+#define PRESET_MAGIC        0xA5
+#define PRESET_IMAGE_LEN    (2 + sizeof(s_presets) + 1)
+
+/* Factory presets: brightness (total flux), CCT (yellow share), recall
+   fade time; same light as the original White/Yellow level pairs */
+static Preset_t code s_factory[PRESET_COUNT] = {
+    {  1,  5, 400 },    /* Endo: W1 + Y1 */
+    {  5,  4, 300 },    /* Mem1: W6 + Y4 */
+    {  6,  6, 300 },    /* Mem2: W4 + Y7 */
+    { 10,  5, 400 },    /* Max:  W10 + Y10 */
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static Preset_t xdata s_presets[PRESET_COUNT];
+static uint8_t xdata s_image[PRESET_IMAGE_LEN];
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+static uint8_t image_sum(uint8_t len)
+{
+    uint8_t i, sum = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        sum += s_image[i];
+    }
+    return sum;
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void preset_init(void)
+{
+    uint8_t i;
+    uint8_t *dst = (uint8_t *)s_presets;
+
+    for (i = 0; i < PRESET_IMAGE_LEN; i++)
+    {
+        s_image[i] = FLASH_READ(FLASH_PRESET_PAGE + i);
+    }
+
+    if (s_image[0] == PRESET_MAGIC && s_image[1] == PRESET_COUNT &&
+        image_sum(PRESET_IMAGE_LEN) == 0)
+    {
+        for (i = 0; i < sizeof(s_presets); i++)
+        {
+            dst[i] = s_image[2 + i];
+        }
+        return;
+    }
+
+    for (i = 0; i < PRESET_COUNT; i++)
+    {
+        s_presets[i] = s_factory[i];
+    }
+}
+
+uint8_t preset_get(uint8_t idx, Preset_t *out)
+{
+    if (idx >= PRESET_COUNT) return 0;
+
+    *out = s_presets[idx];
+    return 1;
+}
+
+uint8_t preset_store(uint8_t idx, uint8_t brightness, uint8_t cct)
+{
+    uint8_t i;
+    uint8_t *src = (uint8_t *)s_presets;
+
+    if (idx >= PRESET_COUNT) return 0;
+
+    s_presets[idx].brightness = brightness;
+    s_presets[idx].cct = cct;
+
+    s_image[0] = PRESET_MAGIC;
+    s_image[1] = PRESET_COUNT;
+    for (i = 0; i < sizeof(s_presets); i++)
+    {
+        s_image[2 + i] = src[i];
+    }
+    s_image[PRESET_IMAGE_LEN - 1] = 0;
+    s_image[PRESET_IMAGE_LEN - 1] = (uint8_t)(0 - image_sum(PRESET_IMAGE_LEN - 1));
+
+    if (!flash_iap_erase(FLASH_PRESET_PAGE)) return 0;
+    return flash_iap_write(FLASH_PRESET_PAGE, s_image, PRESET_IMAGE_LEN);
+}
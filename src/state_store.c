@@ -0,0 +1,333 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     state_store.c
+ * @brief    Wear-leveled persistent state for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Log-structured: every commit appends one full-state record to
+ *           the active page, so a commit never erases. The newest record
+ *           (highest sequence number) wins at boot.
+ *
+ * Record (8 bytes, 16 per page):
+ *   [0..1] sequence  [2..5] State_t  [6] tag  [7] checksum (sum = 0)
+ *   Erased or torn records fail the tag/checksum and are skipped
+ *
+ * Compaction:
+ *   - Active page full: the next record opens the spare page at slot 0;
+ *     the old page becomes the spare
+ *   - The spare is erased later, when no fade is running and no DWIN
+ *     or IR frame is being received, so the ~5ms CPU stall never lands
+ *     in a ramp, a commit or a reception (UART0 would overrun)
+ *   - Power loss at any point leaves at least one valid newest record
+ *
+ * Wear: one erase per 16 commits per page, alternating pages
+ *
+ * Brown-out Slot (FLASH_BOD_PAGE):
+ *   - The next record (sequence + 1, current cache) is kept prebuilt in
+ *     a double buffer, so the BOD ISR only programs 8 bytes into a slot
+ *     of a page that is always erased ahead of time
+ *   - At boot a newer BOD record wins like any other, is copied into the
+ *     log by a normal commit, and the BOD page is then erased again
+ ******************************************************************************/
+
+#include "state_store.h"
+#include "flash_iap.h"
+#include "timebase.h"
+#include "led_fade.h"
+
+#define RECORD_SIZE         8
+#define RECORDS_PER_PAGE    (FLASH_PAGE_SIZE / RECORD_SIZE)
+#define RECORD_TAG          0x5A
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static uint16_t code s_pages[2] = { FLASH_STATE_PAGE0, FLASH_STATE_PAGE1 };
+
+static State_t xdata s_cache;
+static uint8_t xdata s_record[RECORD_SIZE];
+static uint16_t xdata s_seq = 0;          /* Sequence of the newest record */
+static uint8_t xdata s_active = 0;        /* Page index */
+static uint8_t xdata s_slot = 0;          /* Next free slot in the active page */
+static uint16_t xdata s_changed_ms = 0;
+static bit s_dirty = 0;
+static bit s_spare_clean = 0;
+
+/* Brown-out path: prebuilt record (double buffered) and next blank slot */
+static uint8_t xdata s_bod_rec[2][RECORD_SIZE];
+static volatile uint8_t xdata s_bod_sel = 0;
+static volatile uint8_t xdata s_bod_slot = 0;
+static volatile bit s_bod_used = 0;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* Copy a record from flash into s_record; 1 if it is valid */
+static uint8_t record_load(uint16_t addr)
+{
+    uint8_t i, sum = 0;
+
+    for (i = 0; i < RECORD_SIZE; i++)
+    {
+        s_record[i] = FLASH_READ(addr + i);
+        sum += s_record[i];
+    }
+    return (sum == 0 && s_record[6] == RECORD_TAG);
+}
+
+static uint8_t flash_blank(uint16_t addr, uint8_t len)
+{
+    uint8_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (FLASH_READ(addr + i) != 0xFF) return 0;
+    }
+    return 1;
+}
+
+static void record_build(uint8_t xdata *rec, uint16_t seq)
+{
+    uint8_t i, sum = 0;
+
+    rec[0] = (uint8_t)(seq >> 8);
+    rec[1] = (uint8_t)(seq);
+    rec[2] = s_cache.power;
+    rec[3] = s_cache.brightness;
+    rec[4] = s_cache.cct;
+    rec[5] = s_cache.profile;
+    rec[6] = RECORD_TAG;
+    for (i = 0; i < RECORD_SIZE - 1; i++)
+    {
+        sum += rec[i];
+    }
+    rec[RECORD_SIZE - 1] = (uint8_t)(0 - sum);
+}
+
+/* Rebuild the brown-out record in the idle buffer, then switch buffers */
+static void bod_prepare(void)
+{
+    record_build(s_bod_rec[s_bod_sel ^ 1], s_seq + 1);
+    s_bod_sel ^= 1;
+}
+
+/* Adopt a valid record from s_record if it is newer than what we have */
+static uint8_t record_adopt(bit found)
+{
+    uint16_t seq;
+
+    seq = ((uint16_t)s_record[0] << 8) | s_record[1];
+    if (found && (int16_t)(seq - s_seq) <= 0) return 0;
+
+    s_seq = seq;
+    s_cache.power = s_record[2];
+    s_cache.brightness = s_record[3];
+    s_cache.cct = s_record[4];
+    s_cache.profile = s_record[5];
+    return 1;
+}
+
+static void commit(void)
+{
+    uint16_t addr;
+
+    /* Active page full: open the spare (normally pre-erased) */
+    if (s_slot >= RECORDS_PER_PAGE)
+    {
+        if (!s_spare_clean)
+        {
+            flash_iap_erase(s_pages[s_active ^ 1]);
+        }
+        s_active ^= 1;
+        s_slot = 0;
+        s_spare_clean = 0;
+    }
+
+    s_seq++;
+    record_build(s_record, s_seq);
+    addr = s_pages[s_active] + (uint16_t)s_slot * RECORD_SIZE;
+    s_slot++;
+
+    flash_iap_write(addr, s_record, RECORD_SIZE);
+    s_dirty = 0;
+    bod_prepare();
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+uint8_t state_store_init(State_t *out)
+{
+    uint8_t page, slot;
+    bit found = 0;
+    bit from_bod = 0;
+
+    for (page = 0; page < 2; page++)
+    {
+        for (slot = 0; slot < RECORDS_PER_PAGE; slot++)
+        {
+            if (!record_load(s_pages[page] + (uint16_t)slot * RECORD_SIZE)) continue;
+            if (!record_adopt(found)) continue;
+
+            found = 1;
+            s_active = page;
+            s_slot = slot + 1;
+        }
+    }
+
+    /* Brown-out slots: a newer record there is the true last state */
+    s_bod_slot = RECORDS_PER_PAGE;
+    for (slot = 0; slot < RECORDS_PER_PAGE; slot++)
+    {
+        if (flash_blank(FLASH_BOD_PAGE + (uint16_t)slot * RECORD_SIZE, RECORD_SIZE))
+        {
+            if (s_bod_slot == RECORDS_PER_PAGE) s_bod_slot = slot;
+            continue;
+        }
+        s_bod_used = 1;
+        if (!record_load(FLASH_BOD_PAGE + (uint16_t)slot * RECORD_SIZE)) continue;
+        if (!record_adopt(found)) continue;
+
+        found = 1;
+        from_bod = 1;
+    }
+    /* A torn slot before a blank one is not reusable: append after it */
+    if (s_bod_used && s_bod_slot < RECORDS_PER_PAGE &&
+        !flash_blank(FLASH_BOD_PAGE + (uint16_t)s_bod_slot * RECORD_SIZE,
+                     FLASH_PAGE_SIZE - s_bod_slot * RECORD_SIZE))
+    {
+        s_bod_slot = RECORDS_PER_PAGE;
+    }
+
+    s_dirty = 0;
+
+    if (!found)
+    {
+        /* Fresh or corrupt log: start at page 0 after an erase */
+        s_active = 1;
+        s_slot = RECORDS_PER_PAGE;
+        s_spare_clean = flash_blank(s_pages[0], FLASH_PAGE_SIZE);
+        bod_prepare();
+        return 0;
+    }
+
+    /* Copy a brown-out record into the log before its page is reused */
+    if (from_bod)
+    {
+        s_dirty = 1;
+        s_changed_ms = timebase_ms();
+    }
+
+    /* A torn write may have left bytes after the newest record: skip them */
+    while (s_slot < RECORDS_PER_PAGE &&
+           !flash_blank(s_pages[s_active] + (uint16_t)s_slot * RECORD_SIZE, RECORD_SIZE))
+    {
+        s_slot++;
+    }
+
+    s_spare_clean = flash_blank(s_pages[s_active ^ 1], FLASH_PAGE_SIZE);
+    bod_prepare();
+    *out = s_cache;
+    return 1;
+}
+
+void state_store_set(State_t *st)
+{
+    if (st->power == s_cache.power && st->brightness == s_cache.brightness &&
+        st->cct == s_cache.cct && st->profile == s_cache.profile)
+    {
+        return;
+    }
+
+    s_cache = *st;
+    s_dirty = 1;
+    s_changed_ms = timebase_ms();
+    bod_prepare();
+}
+
+void state_store_task(uint8_t quiet)
+{
+    if (s_dirty)
+    {
+        if ((uint16_t)(timebase_ms() - s_changed_ms) >= STATE_COMMIT_DELAY_MS)
+        {
+            commit();
+        }
+        return;
+    }
+
+    if (!quiet || led_fade_busy()) return;
+
+    /* Background compaction: wipe the spare while the light is steady */
+    if (!s_spare_clean)
+    {
+        flash_iap_erase(s_pages[s_active ^ 1]);
+        s_spare_clean = 1;
+    }
+    /* Brown-out record is in the log now: re-arm its page */
+    else if (s_bod_used)
+    {
+        bit ebod = EBOD;
+
+        EBOD = 0;
+        flash_iap_erase(FLASH_BOD_PAGE);
+        s_bod_used = 0;
+        s_bod_slot = 0;
+        EBOD = ebod;
+    }
+}
+
+/*===========================================================================*/
+/* Brown-out Path                                                             */
+/*===========================================================================*/
+void state_store_bod_commit(void)
+{
+    uint8_t xdata *rec;
+    uint16_t addr;
+    uint8_t i;
+
+    if (s_bod_slot >= RECORDS_PER_PAGE) return;
+
+    rec = s_bod_rec[s_bod_sel];
+    addr = FLASH_BOD_PAGE + (uint16_t)s_bod_slot * RECORD_SIZE;
+
+    FLASH_IAP_ENABLE();
+    for (i = 0; i < RECORD_SIZE; i++)
+    {
+        FLASH_IAP_GO(IAP_APROM_PROGRAM, addr + i, rec[i]);
+    }
+    FLASH_IAP_DISABLE();
+
+    s_bod_slot++;
+    s_bod_used = 1;
+}
+
+uint16_t state_store_bod_measure(void)
+{
+    bit ea_save;
+    uint16_t addr, t0, t1;
+    uint8_t i;
+
+    if (s_bod_slot >= RECORDS_PER_PAGE) return 0;
+
+    addr = FLASH_BOD_PAGE + (uint16_t)s_bod_slot * RECORD_SIZE;
+
+    ea_save = EA;
+    EA = 0;
+    TIMEBASE_READ(t0);
+    FLASH_IAP_ENABLE();
+    for (i = 0; i < RECORD_SIZE; i++)
+    {
+        FLASH_IAP_GO(IAP_APROM_PROGRAM, addr + i, 0xFF);
+    }
+    FLASH_IAP_DISABLE();
+    TIMEBASE_READ(t1);
+    EA = ea_save;
+
+    return t1 - t0;
+}
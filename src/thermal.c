@@ -0,0 +1,169 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     thermal.c
+ * @brief    Heatsink NTC thermal derating for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Runs once per oversampled NTC result (every 32ms).
+ *
+ * Signal Path:
+ *   - 16x oversampled sum (Q4 of the 12-bit ADC) -> IIR filter, 1/8
+ *   - Piecewise-linear NTC table (10C steps) -> temperature, Q4 C
+ *
+ * Derating Controller (Q12 limit, 4096 = 100%):
+ *   - Target falls linearly over the START..END band to THERMAL_LIMIT_MIN
+ *   - Limit follows the target through an asymmetric first-order lag:
+ *     fast when cutting (~0.5s), slow when recovering (~4s), so the
+ *     light does not pump while the heatsink settles
+ *   - Open or shorted NTC is treated as END (fail safe)
+ ******************************************************************************/
+
+#include "thermal.h"
+#include "adc_sense.h"
+
+#define NTC_STEP_C          10
+#define NTC_POINTS          14
+
+/* ADC readings outside this window mean a broken sensor */
+#define NTC_ADC_OPEN        4000
+#define NTC_ADC_SHORT       60
+
+/* Filter and controller time constants (shift = 2^n updates) */
+#define TEMP_FILTER_SHIFT   3
+#define LIMIT_CUT_SHIFT     4
+#define LIMIT_RECOVER_SHIFT 7
+
+#define LIMIT_Q12_FULL      ((uint16_t)THERMAL_LIMIT_FULL << 4)
+#define LIMIT_Q12_MIN       ((uint16_t)THERMAL_LIMIT_MIN << 4)
+
+/* 12-bit ADC reading at 0, 10, .. 130C (B3950, 10k pull-up) */
+static uint16_t code s_ntc_table[NTC_POINTS] = {
+    3156, 2738, 2278, 1825, 1419, 1081, 815,
+    613,  462,  350,  267,  206,  160,  126
+};
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static uint16_t xdata s_filt = 0;         /* ADC, Q4 */
+static uint16_t xdata s_temp_q4 = 0;      /* C, Q4 */
+static uint16_t xdata s_limit_q12 = LIMIT_Q12_FULL;
+static uint8_t xdata s_limit_q8 = THERMAL_LIMIT_FULL - 1;
+static bit s_primed = 0;
+static bit s_fault = 0;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+/* Filtered ADC (Q4) -> temperature (Q4 C) */
+static uint16_t ntc_to_temp(uint16_t adc_q4)
+{
+    uint16_t adc = adc_q4 >> 4;
+    uint16_t hi, lo;
+    uint8_t i;
+
+    if (adc >= s_ntc_table[0]) return 0;
+
+    for (i = 1; i < NTC_POINTS; i++)
+    {
+        if (adc >= s_ntc_table[i])
+        {
+            hi = s_ntc_table[i - 1];
+            lo = s_ntc_table[i];
+            return (uint16_t)(i - 1) * (NTC_STEP_C << 4) +
+                   (uint16_t)(((uint32_t)((hi << 4) - adc_q4) * NTC_STEP_C) / (hi - lo));
+        }
+    }
+
+    return (uint16_t)(NTC_POINTS - 1) * (NTC_STEP_C << 4);
+}
+
+/* Temperature (Q4 C) -> limit target (Q12) */
+static uint16_t derate_target(uint16_t temp_q4)
+{
+    uint16_t over;
+
+    if (temp_q4 <= (THERMAL_DERATE_START_C << 4)) return LIMIT_Q12_FULL;
+    if (temp_q4 >= (THERMAL_DERATE_END_C << 4)) return LIMIT_Q12_MIN;
+
+    over = temp_q4 - (THERMAL_DERATE_START_C << 4);
+    return LIMIT_Q12_FULL - (uint16_t)(((uint32_t)(LIMIT_Q12_FULL - LIMIT_Q12_MIN) * over) /
+                                       ((THERMAL_DERATE_END_C - THERMAL_DERATE_START_C) << 4));
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void thermal_init(void)
+{
+    s_primed = 0;
+    s_fault = 0;
+    s_limit_q12 = LIMIT_Q12_FULL;
+    s_limit_q8 = THERMAL_LIMIT_FULL - 1;
+}
+
+uint8_t thermal_task(void)
+{
+    uint16_t sum, target;
+    uint8_t q8;
+
+    if (!adc_sense_ntc(&sum)) return 0;
+
+    /* Oversampled sum is already ADC Q4 */
+    if (!s_primed)
+    {
+        s_filt = sum;
+        s_primed = 1;
+    }
+    else if (sum > s_filt)
+    {
+        s_filt += (sum - s_filt) >> TEMP_FILTER_SHIFT;
+    }
+    else
+    {
+        s_filt -= (s_filt - sum) >> TEMP_FILTER_SHIFT;
+    }
+
+    s_fault = (s_filt > (NTC_ADC_OPEN << 4) || s_filt < (NTC_ADC_SHORT << 4));
+    if (s_fault)
+    {
+        target = LIMIT_Q12_MIN;
+    }
+    else
+    {
+        s_temp_q4 = ntc_to_temp(s_filt);
+        target = derate_target(s_temp_q4);
+    }
+
+    if (target < s_limit_q12)
+    {
+        s_limit_q12 -= ((s_limit_q12 - target) >> LIMIT_CUT_SHIFT) + 1;
+    }
+    else if (target > s_limit_q12)
+    {
+        s_limit_q12 += ((target - s_limit_q12) >> LIMIT_RECOVER_SHIFT) + 1;
+    }
+
+    /* Report whole Q8 steps only, so the duty is not re-applied every 32ms */
+    q8 = (uint8_t)((s_limit_q12 >> 4) - 1);
+    if (q8 == s_limit_q8) return 0;
+
+    s_limit_q8 = q8;
+    return 1;
+}
+
+uint16_t thermal_limit(void)
+{
+    return (uint16_t)s_limit_q8 + 1;
+}
+
+uint8_t thermal_temp_c(void)
+{
+    if (s_fault) return 0xFF;
+    return (uint8_t)(s_temp_q4 >> 4);
+}
@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     timebase.c
+ * @brief    System timebase on Timer2 for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Timer2 runs free (compare mode, no auto-clear) at Fsys/16.
+ *           The 1ms tick is a software output compare: each match moves
+ *           RCMP2 forward by TIMEBASE_TICKS_PER_MS, so the counter itself
+ *           stays usable as a wrapping 16-bit timestamp.
+ *           The tick also steps the LED fade engine (led_fade.c) and
+ *           starts the scheduled ADC conversion (adc_sense.c) and counts
+ *           down the task deadlines (watchdog.c) and times the RS-485
+ *           bus turnaround (uart1.c).
+ ******************************************************************************/
+
+#include "timebase.h"
+#include "led_fade.h"
+#include "thermal.h"
+#include "adc_sense.h"
+#include "watchdog.h"
+#include "uart1.h"
+#include "boot_trace.h"
+
+/* T2MOD: T2DIV = 010 (Fsys/16), CMPCR = 0 (no clear on match) */
+#define T2MOD_DIV16         0x20
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static volatile uint16_t s_ms = 0;
+static uint16_t s_compare = 0;
+
+/*===========================================================================*/
+/* Timer2 Compare Interrupt - 1ms tick (Vector 5)                             */
+/*===========================================================================*/
+void Timer2_ISR(void) interrupt 5
+{
+    TF2 = 0;
+
+    s_compare += TIMEBASE_TICKS_PER_MS;
+    RCMP2L = (uint8_t)(s_compare);
+    RCMP2H = (uint8_t)(s_compare >> 8);
+
+    s_ms++;
+
+#if BOOT_TRACE_ENABLE
+    if (s_ms == BOOT_TRACE_WINDOW_MS) boot_trace_close();
+#endif
+    led_fade_tick();
+#if THERMAL_ENABLE || ADC_ISENSE_ENABLE
+    adc_sense_tick();
+#endif
+#if WATCHDOG_ENABLE
+    watchdog_tick();
+#endif
+#if UART1_DRIVER
+    uart1_tick();
+#endif
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void timebase_init(void)
+{
+    clr_T2CON_TR2;
+    clr_T2CON_TF2;
+
+    T2MOD = T2MOD_DIV16;
+    set_T2CON_CM_RL2;           /* Compare mode */
+
+    TL2 = 0;
+    TH2 = 0;
+    s_compare = TIMEBASE_TICKS_PER_MS;
+    RCMP2L = (uint8_t)(s_compare);
+    RCMP2H = (uint8_t)(s_compare >> 8);
+
+    set_EIE_ET2;
+    set_T2CON_TR2;
+}
+
+uint16_t timebase_ms(void)
+{
+    uint16_t ms;
+
+    clr_EIE_ET2;
+    ms = s_ms;
+    set_EIE_ET2;
+
+    return ms;
+}
+
+uint16_t timebase_ticks(void)
+{
+    uint16_t t;
+
+    TIMEBASE_READ(t);
+    return t;
+}
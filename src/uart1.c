@@ -0,0 +1,201 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     uart1.c
+ * @brief    Interrupt-driven UART1 / RS-485 driver for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Same ring scheme as the UART0 path in main.c: the ISR fills the
+ *           RX ring and drains the TX ring, setting TI_1 kicks a transfer.
+ *
+ * Bus turnaround (half duplex):
+ *   - uart1_write() raises DE before the first byte
+ *   - TI_1 is set at the start of the stop bit, so the ISR cannot drop DE
+ *     on the last byte; it arms a countdown instead and uart1_tick()
+ *     releases the bus UART1_TURNAROUND_MS later
+ *   - DE and /RE are tied: our own frames are not received back
+ *
+ * Even parity: mode 3, the 9th bit carries the parity of the data byte
+ * (PSW.P after loading ACC). A mismatch on receive sets the error flag,
+ * the byte is kept so that frame gaps stay intact.
+ ******************************************************************************/
+
+#include "uart1.h"
+#include "Common.h"
+
+#if UART1_DRIVER
+
+#define UART1_RX_MASK       (UART1_RX_SIZE - 1)
+#define UART1_TX_MASK       (UART1_TX_SIZE - 1)
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static volatile uint8_t xdata s_rx_buf[UART1_RX_SIZE];
+static volatile uint8_t s_rx_head = 0;
+static volatile uint8_t s_rx_tail = 0;
+static volatile uint8_t s_rx_idle = 0xFF;   /* Ticks since the last byte */
+static volatile bit s_rx_error = 0;
+static bit s_parity = 0;
+
+static uint8_t xdata s_tx_buf[UART1_TX_SIZE];
+static volatile uint8_t s_tx_head = 0;
+static volatile uint8_t s_tx_tail = 0;
+static volatile bit s_tx_busy = 0;      /* Driver on, from first byte to release */
+static volatile uint8_t s_turn = 0;     /* Ticks until release, 0 = not draining */
+
+/*===========================================================================*/
+/* UART1 Interrupt (Vector 15)                                                */
+/*===========================================================================*/
+void UART1_ISR(void) interrupt 15
+{
+    uint8_t d;
+
+    if (RI_1)
+    {
+        uint8_t next_head;
+        next_head = (s_rx_head + 1) & UART1_RX_MASK;
+
+        d = SBUF_1;
+        ACC = d;
+        if (s_parity && RB8_1 != P) s_rx_error = 1;
+
+        if (next_head != s_rx_tail)
+        {
+            s_rx_buf[s_rx_head] = d;
+            s_rx_head = next_head;
+        }
+        else
+        {
+            s_rx_error = 1;
+        }
+        s_rx_idle = 0;
+        RI_1 = 0;
+    }
+
+    if (TI_1)
+    {
+        TI_1 = 0;
+
+        if (s_tx_tail != s_tx_head)
+        {
+            d = s_tx_buf[s_tx_tail];
+            ACC = d;
+            TB8_1 = P;
+            SBUF_1 = d;
+            s_tx_tail = (s_tx_tail + 1) & UART1_TX_MASK;
+        }
+        else
+        {
+            /* Last stop bit still on the wire */
+            s_turn = UART1_TURNAROUND_MS;
+        }
+    }
+}
+
+/*===========================================================================*/
+/* Bus Turnaround + Idle Timer - timebase ISR context                         */
+/*===========================================================================*/
+void uart1_tick(void)
+{
+    if (s_rx_idle != 0xFF) s_rx_idle++;
+
+    if (s_turn && --s_turn == 0)
+    {
+        UART1_DE_PIN = 0;
+        s_tx_busy = 0;
+    }
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void uart1_init(unsigned long u32Baudrate, uint8_t parity)
+{
+    UART1_DE_PIN = 0;
+    P00_PUSHPULL_MODE;
+
+    InitialUART1_Timer3(u32Baudrate);
+    s_parity = (parity == UART1_PARITY_EVEN) ? 1 : 0;
+    if (s_parity)
+    {
+        SM0_1 = 1;              /* Mode 3: 9-bit, Timer3 baud rate */
+    }
+    RI_1 = 0;
+    set_EIE1_ES_1;
+}
+
+uint8_t uart1_available(void)
+{
+    return (s_rx_head - s_rx_tail) & UART1_RX_MASK;
+}
+
+uint8_t uart1_read(void)
+{
+    uint8_t d;
+
+    if (s_rx_head == s_rx_tail) return 0;
+
+    d = s_rx_buf[s_rx_tail];
+    s_rx_tail = (s_rx_tail + 1) & UART1_RX_MASK;
+    return d;
+}
+
+uint8_t uart1_rx_idle_ms(void)
+{
+    return s_rx_idle;
+}
+
+uint8_t uart1_rx_error(void)
+{
+    uint8_t err;
+
+    clr_EIE1_ES_1;
+    err = s_rx_error;
+    s_rx_error = 0;
+    set_EIE1_ES_1;
+
+    return err;
+}
+
+uint8_t uart1_write(uint8_t xdata *buf, uint8_t len)
+{
+    uint8_t head;
+
+    /* Whole frame or nothing: a split frame would break the bus timing */
+    if (len > ((s_tx_tail - s_tx_head - 1) & UART1_TX_MASK)) return 0;
+
+    head = s_tx_head;
+    while (len--)
+    {
+        s_tx_buf[head] = *buf++;
+        head = (head + 1) & UART1_TX_MASK;
+    }
+
+    clr_EIE1_ES_1;
+    clr_EIE_ET2;
+    s_tx_head = head;
+    if (!s_tx_busy || s_turn)
+    {
+        /* Idle or releasing: (re)take the bus and kick the ISR */
+        s_turn = 0;
+        s_tx_busy = 1;
+        UART1_DE_PIN = 1;
+        TI_1 = 1;
+    }
+    set_EIE_ET2;
+    set_EIE1_ES_1;
+
+    return 1;
+}
+
+uint8_t uart1_tx_idle(void)
+{
+    return s_tx_busy ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     warm_state.c
+ * @brief    Warm-reset state preservation for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     XRAM keeps its content through watchdog, software, brown-out
+ *           and pin resets; only STARTUP.A51 clears it. The last 16 bytes
+ *           are left out of that clear, so the live light state survives
+ *           and main() can relight before any other init or DWIN traffic.
+ *
+ * Image Layout (NOINIT_WARM_ADDR):
+ *   [magic 0xC3][power][brightness][cct][profile][check]
+ *   check = ~(sum of the bytes before it), so an all-zero image fails
+ ******************************************************************************/
+
+#include "warm_state.h"
+
+#define WARM_MAGIC          0xC3
+#define PCON_POF            0x10
+
+typedef struct
+{
+    uint8_t magic;
+    State_t st;
+    uint8_t check;
+} Warm_Image_t;
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+/* Absolute, never cleared by startup code */
+static Warm_Image_t xdata s_image _at_ NOINIT_WARM_ADDR;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+static uint8_t image_check(void)
+{
+    return (uint8_t)~(s_image.magic + s_image.st.power + s_image.st.brightness +
+                      s_image.st.cct + s_image.st.profile);
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+uint8_t warm_state_load(State_t *out)
+{
+    /* Power-on: XRAM content is random. POF stays set for the HIRC
+       trim, MODIFY_HIRC_24576() in main(), which clears it */
+    if (PCON & PCON_POF)
+    {
+        s_image.magic = 0;
+        return 0;
+    }
+
+    if (s_image.magic != WARM_MAGIC || s_image.check != image_check()) return 0;
+
+    *out = s_image.st;
+    return 1;
+}
+
+void warm_state_save(State_t *st)
+{
+    if (s_image.magic == WARM_MAGIC &&
+        s_image.st.power == st->power &&
+        s_image.st.brightness == st->brightness &&
+        s_image.st.cct == st->cct &&
+        s_image.st.profile == st->profile)
+    {
+        return;
+    }
+
+    s_image.magic = WARM_MAGIC;
+    s_image.st = *st;
+    s_image.check = image_check();
+}
@@ -0,0 +1,192 @@
+/*---------------------------------------------------------------------------------------------------------*/
+/*                                                                                                         */
+/* SPDX-License-Identifier: Apache-2.0                                                                     */
+/* Copyright(c) 2024 Nuvoton Technology Corp. All rights reserved.                                         */
+/*                                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/******************************************************************************
+ * @file     watchdog.c
+ * @brief    Watchdog supervisor for MS51FB9AE @ 24MHz HIRC
+ * @version  1.0.0
+ * @note     Kicking the WDT from one place in the main loop only proves the
+ *           loop runs, not that each task gets through. Here every task
+ *           owns a deadline counter and the WDT is only cleared while all
+ *           of them are alive.
+ *
+ * Supervision:
+ *   - Main loop: watchdog_checkin(task) reloads that task's deadline
+ *   - Timebase ISR: counts all deadlines down. The hung task is the first
+ *     one to reach 0 (later tasks checked in after it on the last pass).
+ *     It is written to the no-init record and the MCU software-resets at
+ *     once; warm_state.c relights in the previous state
+ *   - Hardware WDT (1.64s) only fires if the timebase ISR itself stops.
+ *     CONFIG4 enables it from reset, so watchdog_init() sets its period
+ *     right away and the tick clears it from then on, deadlines or not
+ *
+ * No-init Record (NOINIT_WATCHDOG_ADDR):
+ *   [magic 0x3C][pending task][miss count][check = ~sum]
+ ******************************************************************************/
+
+#include "watchdog.h"
+#include "warm_state.h"
+
+#define WDT_MAGIC           0x3C
+#define WDT_KICK_MS         64      /* Hardware WDT clear interval */
+
+/* Reset flags */
+#define PCON_POF            0x10
+#define AUXR1_SWRF          0x80
+#define AUXR1_RSTPINF       0x40
+#define WDCON_WDTRF         0x08
+#define BODCON0_BORF        0x02
+
+typedef struct
+{
+    uint8_t magic;
+    uint8_t task;       /* Pending miss for the next boot, or WDT_TASK_NONE */
+    uint8_t misses;
+    uint8_t check;
+} Wdt_Record_t;
+
+/*===========================================================================*/
+/* Module Variables                                                           */
+/*===========================================================================*/
+static Wdt_Record_t xdata s_rec _at_ NOINIT_WATCHDOG_ADDR;
+
+static uint16_t code s_deadline[WDT_TASK_COUNT] = {
+    WDT_DEADLINE_IR_MS, WDT_DEADLINE_DWIN_MS,
+    WDT_DEADLINE_STATE_MS, WDT_DEADLINE_SENSE_MS
+};
+
+static volatile uint16_t xdata s_left[WDT_TASK_COUNT];
+static volatile bit s_running = 0;
+static uint8_t xdata s_kick = 0;
+static uint8_t xdata s_cause = RESET_POWER_ON;
+static uint8_t xdata s_missed = WDT_TASK_NONE;
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+#define RECORD_CHECK()      ((uint8_t)~(s_rec.magic + s_rec.task + s_rec.misses))
+
+/*===========================================================================*/
+/* Deadline Tick - timebase ISR context                                       */
+/*===========================================================================*/
+void watchdog_tick(void)
+{
+    uint8_t t;
+
+    if (++s_kick >= WDT_KICK_MS)
+    {
+        s_kick = 0;
+        TA = 0xAA; TA = 0x55; WDCON |= 0x40;
+    }
+
+    if (!s_running) return;
+
+    for (t = 0; t < WDT_TASK_COUNT; t++)
+    {
+        if (s_left[t] != 0)
+        {
+            s_left[t]--;
+            continue;
+        }
+
+        /* Missed: leave the culprit for the next boot, restart now */
+        s_rec.magic = WDT_MAGIC;
+        s_rec.task = t;
+        if (s_rec.misses != 0xFF) s_rec.misses++;
+        s_rec.check = RECORD_CHECK();
+
+        EA = 0;
+        TA = 0xAA; TA = 0x55; CHPCON |= 0x80;
+    }
+}
+
+/*===========================================================================*/
+/* Public API                                                                 */
+/*===========================================================================*/
+void watchdog_init(void)
+{
+    bit valid;
+
+    /* Running since reset: period first, then a fresh count */
+    TA = 0xAA; TA = 0x55; WDCON = (WDCON & 0xF8) | WDT_WDPS;
+    set_WDCON_WDCLR;
+
+    valid = (s_rec.magic == WDT_MAGIC && s_rec.check == RECORD_CHECK());
+
+    if (PCON & PCON_POF)
+    {
+        s_cause = RESET_POWER_ON;
+        valid = 0;
+    }
+    else if (WDCON & WDCON_WDTRF)
+    {
+        s_cause = RESET_WATCHDOG;
+    }
+    else if (AUXR1 & AUXR1_SWRF)
+    {
+        s_cause = (valid && s_rec.task != WDT_TASK_NONE) ? RESET_TASK_MISS : RESET_SOFTWARE;
+    }
+    else if (BODCON0 & BODCON0_BORF)
+    {
+        s_cause = RESET_BROWN_OUT;
+    }
+    else if (AUXR1 & AUXR1_RSTPINF)
+    {
+        s_cause = RESET_PIN;
+    }
+
+    if (!valid)
+    {
+        s_rec.magic = WDT_MAGIC;
+        s_rec.task = WDT_TASK_NONE;
+        s_rec.misses = 0;
+    }
+    if (s_cause == RESET_TASK_MISS) s_missed = s_rec.task;
+
+    /* Consumed: a later plain software reset is not a miss */
+    s_rec.task = WDT_TASK_NONE;
+    s_rec.check = RECORD_CHECK();
+
+    clr_WDCON_WDTRF;
+    AUXR1 &= ~(AUXR1_SWRF | AUXR1_RSTPINF);
+    TA = 0xAA; TA = 0x55; BODCON0 &= ~BODCON0_BORF;
+}
+
+void watchdog_start(void)
+{
+    uint8_t t;
+
+    clr_EIE_ET2;
+    for (t = 0; t < WDT_TASK_COUNT; t++)
+    {
+        s_left[t] = s_deadline[t];
+    }
+    s_running = 1;
+    set_EIE_ET2;
+}
+
+void watchdog_checkin(uint8_t task)
+{
+    clr_EIE_ET2;
+    s_left[task] = s_deadline[task];
+    set_EIE_ET2;
+}
+
+uint8_t watchdog_reset_cause(void)
+{
+    return s_cause;
+}
+
+uint8_t watchdog_missed_task(void)
+{
+    return s_missed;
+}
+
+uint8_t watchdog_miss_count(void)
+{
+    return s_rec.misses;
+}
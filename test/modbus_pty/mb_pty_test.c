@@ -0,0 +1,236 @@
+/*--------------------------------------------------------------------------
+mb_pty_test.c
+
+Runs src/modbus.c as a slave on one end of a pty (uart1_pty.c) in a child
+process and plays the Modbus master on the other end.
+--------------------------------------------------------------------------*/
+#define _XOPEN_SOURCE 600
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "modbus.h"
+#include "uart1_pty.h"
+
+#define REPLY_TIMEOUT_MS    200     /* First byte of a reply */
+#define GAP_MS              20      /* Silence that ends a reply */
+
+static int s_bus = -1;
+static int s_failed = 0;
+
+/*===========================================================================*/
+/* Slave                                                                      */
+/*===========================================================================*/
+static void run_slave(void)
+{
+    modbus_init();
+    modbus_set(MB_REG_POWER, 1);
+    modbus_set(MB_REG_BRIGHT, 7);
+    modbus_set(MB_REG_CCT, 3);
+    modbus_set(MB_REG_PROFILE, 0);
+    modbus_set(MB_REG_RECALL, 0);
+    modbus_set(MB_REG_STORE, 0);
+    modbus_set(MB_REG_FAULT, 0);
+
+    for (;;)
+    {
+        modbus_task();
+        usleep(200);
+    }
+}
+
+/*===========================================================================*/
+/* Master                                                                     */
+/*===========================================================================*/
+/* Bitwise CRC-16/MODBUS, independent of the slave's tables */
+static uint16_t crc16(const uint8_t *buf, int len)
+{
+    uint16_t crc = 0xFFFF;
+    int i, j;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (j = 0; j < 8; j++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+
+    return crc;
+}
+
+/* Send a request (CRC appended unless bad_crc) and collect the reply */
+static int transact(const uint8_t *req, int len, int bad_crc, uint8_t *rsp)
+{
+    struct pollfd pfd;
+    uint8_t frame[64];
+    uint16_t crc;
+    int n, got;
+
+    memcpy(frame, req, len);
+    crc = crc16(req, len) ^ (bad_crc ? 0x0001 : 0);
+    frame[len] = (uint8_t)crc;
+    frame[len + 1] = (uint8_t)(crc >> 8);
+    if (write(s_bus, frame, len + 2) != len + 2) return -1;
+
+    pfd.fd = s_bus;
+    pfd.events = POLLIN;
+    got = 0;
+    while (got < 64 && poll(&pfd, 1, got ? GAP_MS : REPLY_TIMEOUT_MS) > 0)
+    {
+        n = read(s_bus, rsp + got, 64 - got);
+        if (n <= 0) break;
+        got += n;
+    }
+
+    /* t3.5 before the next request */
+    usleep(5000);
+    return got;
+}
+
+/* want_len 0 = the slave must stay silent */
+static void check(const char *name, const uint8_t *req, int len, int bad_crc,
+                  const uint8_t *want, int want_len)
+{
+    uint8_t rsp[64];
+    uint16_t crc;
+    int got, ok, i;
+
+    got = transact(req, len, bad_crc, rsp);
+    if (want_len == 0)
+    {
+        ok = (got == 0);
+    }
+    else
+    {
+        crc = crc16(rsp, want_len);
+        ok = (got == want_len + 2 && memcmp(rsp, want, want_len) == 0 &&
+              rsp[want_len] == (uint8_t)crc && rsp[want_len + 1] == (uint8_t)(crc >> 8));
+    }
+
+    printf("%-4s %s", ok ? "ok" : "FAIL", name);
+    if (!ok)
+    {
+        printf(" (got");
+        for (i = 0; i < got; i++) printf(" %02X", rsp[i]);
+        printf(")");
+        s_failed++;
+    }
+    printf("\n");
+}
+
+#define CHECK(name, req, want) \
+    check(name, req, sizeof(req), 0, want, sizeof(want))
+#define CHECK_SILENT(name, req) \
+    check(name, req, sizeof(req), 0, NULL, 0)
+
+static void run_master(void)
+{
+    /* 03 Read Holding Registers */
+    static const uint8_t rd_all[] = { 1, 0x03, 0, 0, 0, 7 };
+    static const uint8_t rd_all_ok[] = { 1, 0x03, 14, 0, 1, 0, 7, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0 };
+    static const uint8_t rd_past[] = { 1, 0x03, 0, 6, 0, 2 };
+    static const uint8_t rd_past_ex[] = { 1, 0x83, 0x02 };
+    static const uint8_t rd_none[] = { 1, 0x03, 0, 0, 0, 0 };
+    static const uint8_t rd_none_ex[] = { 1, 0x83, 0x03 };
+    static const uint8_t rd_012[] = { 1, 0x03, 0, 0, 0, 3 };
+    static const uint8_t rd_bright[] = { 1, 0x03, 0, 1, 0, 1 };
+
+    /* 06 Write Single */
+    static const uint8_t wr_bright[] = { 1, 0x06, 0, 1, 0, 5 };
+    static const uint8_t rd_bright_5[] = { 1, 0x03, 2, 0, 5 };
+    static const uint8_t wr_bright_big[] = { 1, 0x06, 0, 1, 0, 11 };
+    static const uint8_t wr_single_ex_value[] = { 1, 0x86, 0x03 };
+    static const uint8_t wr_past[] = { 1, 0x06, 0, 7, 0, 0 };
+    static const uint8_t wr_single_ex_addr[] = { 1, 0x86, 0x02 };
+
+    /* 16 Write Multiple */
+    static const uint8_t wm_012[] = { 1, 0x10, 0, 0, 0, 3, 6, 0, 1, 0, 9, 0, 2 };
+    static const uint8_t wm_012_ok[] = { 1, 0x10, 0, 0, 0, 3 };
+    static const uint8_t rd_012_192[] = { 1, 0x03, 6, 0, 1, 0, 9, 0, 2 };
+    static const uint8_t wm_bad_cct[] = { 1, 0x10, 0, 0, 0, 3, 6, 0, 0, 0, 4, 0, 12 };
+    static const uint8_t wm_ex_value[] = { 1, 0x90, 0x03 };
+    static const uint8_t wm_bad_count[] = { 1, 0x10, 0, 0, 0, 2, 6, 0, 1, 0, 9, 0, 2 };
+    static const uint8_t wm_past[] = { 1, 0x10, 0, 6, 0, 2, 4, 0, 0, 0, 0 };
+    static const uint8_t wm_ex_addr[] = { 1, 0x90, 0x02 };
+
+    /* Other functions */
+    static const uint8_t rd_input[] = { 1, 0x04, 0, 0, 0, 1 };
+    static const uint8_t rd_input_ex[] = { 1, 0x84, 0x01 };
+
+    /* Broadcast and foreign frames */
+    static const uint8_t bc_cct[] = { 0, 0x06, 0, 2, 0, 4 };
+    static const uint8_t rd_cct[] = { 1, 0x03, 0, 2, 0, 1 };
+    static const uint8_t rd_cct_4[] = { 1, 0x03, 2, 0, 4 };
+    static const uint8_t bc_multi[] = { 0, 0x10, 0, 0, 0, 2, 4, 0, 0, 0, 3 };
+    static const uint8_t rd_01[] = { 1, 0x03, 0, 0, 0, 2 };
+    static const uint8_t rd_01_03[] = { 1, 0x03, 4, 0, 0, 0, 3 };
+    static const uint8_t bc_read[] = { 0, 0x03, 0, 0, 0, 1 };
+    static const uint8_t bc_bad[] = { 0, 0x06, 0, 1, 0, 99 };
+    static const uint8_t rd_bright_3[] = { 1, 0x03, 2, 0, 3 };
+    static const uint8_t other_slave[] = { 2, 0x06, 0, 1, 0, 1 };
+
+    CHECK("03 read all registers", rd_all, rd_all_ok);
+    CHECK("03 read past the map: exception 02", rd_past, rd_past_ex);
+    CHECK("03 read zero registers: exception 03", rd_none, rd_none_ex);
+
+    CHECK("06 write brightness: echo", wr_bright, wr_bright);
+    CHECK("06 value stored", rd_bright, rd_bright_5);
+    CHECK("06 value above the limit: exception 03", wr_bright_big, wr_single_ex_value);
+    CHECK("06 register past the map: exception 02", wr_past, wr_single_ex_addr);
+    CHECK("06 rejected value not stored", rd_bright, rd_bright_5);
+
+    CHECK("16 write power/brightness/CCT", wm_012, wm_012_ok);
+    CHECK("16 values stored", rd_012, rd_012_192);
+    CHECK("16 one bad value: exception 03", wm_bad_cct, wm_ex_value);
+    CHECK("16 nothing stored after a bad value", rd_012, rd_012_192);
+    CHECK("16 byte count mismatch: exception 03", wm_bad_count, wm_ex_value);
+    CHECK("16 range past the map: exception 02", wm_past, wm_ex_addr);
+
+    CHECK("04 unsupported function: exception 01", rd_input, rd_input_ex);
+
+    CHECK_SILENT("broadcast 06: no reply", bc_cct);
+    CHECK("broadcast 06 stored", rd_cct, rd_cct_4);
+    CHECK_SILENT("broadcast 16: no reply", bc_multi);
+    CHECK("broadcast 16 stored", rd_01, rd_01_03);
+    CHECK_SILENT("broadcast 03: no reply", bc_read);
+    CHECK_SILENT("broadcast bad value: no exception", bc_bad);
+    CHECK("broadcast bad value not stored", rd_bright, rd_bright_3);
+    CHECK_SILENT("other slave address: ignored", other_slave);
+    check("bad CRC: ignored", rd_all, sizeof(rd_all), 1, NULL, 0);
+}
+
+int main(void)
+{
+    char name[64];
+    pid_t pid;
+
+    s_bus = uart1_pty_open(name, sizeof(name));
+    if (s_bus < 0)
+    {
+        perror("pty");
+        return 2;
+    }
+    printf("slave on %s\n", name);
+    fflush(stdout);
+
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return 2;
+    }
+    if (pid == 0) run_slave();
+
+    run_master();
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+
+    printf("%s: %d failed\n", s_failed ? "FAIL" : "PASS", s_failed);
+    return s_failed ? 1 : 0;
+}
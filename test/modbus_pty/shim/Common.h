@@ -0,0 +1,9 @@
+/*--------------------------------------------------------------------------
+Common.h
+
+Host stand-in: no vendor UART helpers
+--------------------------------------------------------------------------*/
+#ifndef __COMMON_H__
+#define __COMMON_H__
+
+#endif
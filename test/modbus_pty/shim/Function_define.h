@@ -0,0 +1,19 @@
+/*--------------------------------------------------------------------------
+Function_define.h
+
+Host stand-in: the C51 integer widths (int is 16 bit there)
+--------------------------------------------------------------------------*/
+#ifndef _FUNCTION_DEFINE_H_
+#define _FUNCTION_DEFINE_H_
+
+typedef unsigned char   UINT8;
+typedef unsigned short  UINT16;
+typedef unsigned int    UINT32;
+
+typedef unsigned char   uint8_t;
+typedef unsigned short  uint16_t;
+typedef unsigned int    uint32_t;
+
+typedef unsigned char   BIT;
+
+#endif
@@ -0,0 +1,9 @@
+/*--------------------------------------------------------------------------
+MS51_16K.h
+
+Host stand-in: the modules under test touch no SFR
+--------------------------------------------------------------------------*/
+#ifndef _MS51_16K_H_
+#define _MS51_16K_H_
+
+#endif
@@ -0,0 +1,9 @@
+/*--------------------------------------------------------------------------
+SFR_Macro.h
+
+Host stand-in: the modules under test touch no SFR
+--------------------------------------------------------------------------*/
+#ifndef _SFR_MACRO_H_
+#define _SFR_MACRO_H_
+
+#endif
@@ -0,0 +1,17 @@
+/*--------------------------------------------------------------------------
+c51.h
+
+Keil C51 keywords for a host compiler (forced in with -include)
+--------------------------------------------------------------------------*/
+#ifndef _C51_H_
+#define _C51_H_
+
+#define bit         unsigned char
+#define code        const
+#define data
+#define idata
+#define xdata
+#define pdata
+#define reentrant
+
+#endif
@@ -0,0 +1,153 @@
+/*--------------------------------------------------------------------------
+uart1_pty.c
+
+Host stand-in for uart1.c: the RS-485 port is a pty, the Timer2 timebase
+is the monotonic clock. Same API as uart1.h, no parity on a pty.
+--------------------------------------------------------------------------*/
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "uart1.h"
+#include "uart1_pty.h"
+
+#define UART1_RX_MASK   (UART1_RX_SIZE - 1)
+
+static int s_fd = -1;
+static uint8_t s_rx_buf[UART1_RX_SIZE];
+static uint8_t s_rx_head = 0;
+static uint8_t s_rx_tail = 0;
+static uint8_t s_rx_error = 0;
+static long s_rx_last_ms = 0;
+
+static long now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* What the RX ISR would have queued by now */
+static void poll_rx(void)
+{
+    uint8_t b;
+
+    while (read(s_fd, &b, 1) == 1)
+    {
+        if ((uint8_t)(s_rx_head - s_rx_tail) < UART1_RX_SIZE)
+        {
+            s_rx_buf[s_rx_head & UART1_RX_MASK] = b;
+            s_rx_head++;
+        }
+        else
+        {
+            s_rx_error = 1;
+        }
+        s_rx_last_ms = now_ms();
+    }
+}
+
+/*===========================================================================*/
+/* Pty                                                                        */
+/*===========================================================================*/
+int uart1_pty_open(char *name, int size)
+{
+    struct termios tio;
+    int fd;
+
+    s_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (s_fd < 0 || grantpt(s_fd) != 0 || unlockpt(s_fd) != 0) return -1;
+    snprintf(name, size, "%s", ptsname(s_fd));
+
+    /* Raw line discipline, set from the far end */
+    fd = open(name, O_RDWR | O_NOCTTY);
+    if (fd < 0) return -1;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    fcntl(s_fd, F_SETFL, fcntl(s_fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/*===========================================================================*/
+/* uart1.h                                                                    */
+/*===========================================================================*/
+void uart1_init(unsigned long u32Baudrate, uint8_t parity)
+{
+    (void)u32Baudrate;
+    (void)parity;
+
+    s_rx_head = 0;
+    s_rx_tail = 0;
+    s_rx_error = 0;
+    s_rx_last_ms = now_ms();
+}
+
+uint8_t uart1_available(void)
+{
+    poll_rx();
+    return (uint8_t)(s_rx_head - s_rx_tail);
+}
+
+uint8_t uart1_read(void)
+{
+    uint8_t b;
+
+    if (s_rx_head == s_rx_tail) return 0;
+
+    b = s_rx_buf[s_rx_tail & UART1_RX_MASK];
+    s_rx_tail++;
+    return b;
+}
+
+uint8_t uart1_rx_idle_ms(void)
+{
+    long idle;
+
+    poll_rx();
+    idle = now_ms() - s_rx_last_ms;
+    return (idle > 255) ? 255 : (uint8_t)idle;
+}
+
+uint8_t uart1_rx_error(void)
+{
+    uint8_t err;
+
+    err = s_rx_error;
+    s_rx_error = 0;
+    return err;
+}
+
+uint8_t uart1_write(uint8_t xdata *buf, uint8_t len)
+{
+    uint8_t done;
+    ssize_t n;
+
+    for (done = 0; done < len; done += (uint8_t)n)
+    {
+        n = write(s_fd, buf + done, len - done);
+        if (n <= 0)
+        {
+            n = 0;
+            usleep(100);
+        }
+    }
+
+    return 1;
+}
+
+uint8_t uart1_tx_idle(void)
+{
+    return 1;
+}
+
+void uart1_tick(void)
+{
+}
@@ -0,0 +1,17 @@
+/*--------------------------------------------------------------------------
+uart1_pty.h
+
+Binds the uart1.h stand-in to a pty
+--------------------------------------------------------------------------*/
+#ifndef _UART1_PTY_H_
+#define _UART1_PTY_H_
+
+/**
+ * @brief  Create the pty the firmware side talks on
+ * @param  name: Receives the path of the far end
+ * @param  size: Size of name
+ * @retval Far end file descriptor, raw mode (the bus master's side), -1 = error
+ */
+int uart1_pty_open(char *name, int size);
+
+#endif